@@ -31,8 +31,16 @@
 // #define ACTIONRINGBUFFER_STAT // To be uncommented when doing Statistics
 
 
+// Overflow policies, i.e. behavior of Append() in case of buffer full
+enum e_ActionRingBufferOverflowPolicy {
+  ACTIONRINGBUFFER_DROP_OLDEST = 0, // the new data overwrites the oldest one (default policy)
+  ACTIONRINGBUFFER_REJECT_NEWEST,   // the new data is rejected
+  ACTIONRINGBUFFER_BLOCK            // wait for free space till a timeout, the new data is rejected on timeout
+};
+
+
 // The type of the contained elements and the ring buffer size are defined at compile time (template)
-// In case of buffer full, a new appended data overwrites the oldest one
+// In case of buffer full, the behavior depends on the overflow policy (by default a new appended data overwrites the oldest one)
 
 template<typename T, word size>
 class ActionRingBuffer {
@@ -41,9 +49,18 @@ class ActionRingBuffer {
      T _buffer[size]; // elements buffer
      byte _size;
      byte _elementsCurrentNb;
+     e_ActionRingBufferOverflowPolicy _overflowPolicy;
+     void (*_droppedFct)(const T&); // called with the oldest data when it gets overwritten (DROP_OLDEST policy)
+     boolean (*_waitFct)(void);     // called repeatedly while waiting for free space (BLOCK policy)
+                                    // it shall return false when waiting is not possible
+     word _blockTimeoutMillis;      // max waiting time (BLOCK policy)
 #ifdef ACTIONRINGBUFFER_STAT
      byte _elementsMaxNb;
      word _lostElementsNb;
+     word _replacedElementsNb;
+     word _rejectedElementsNb;
+     word _blockedAppendsNb;
+     word _blockTimeoutsNb;
 #endif
 
   public : 
@@ -55,33 +72,73 @@ class ActionRingBuffer {
       _tail = 0;
       _elementsCurrentNb = 0;
       _size = size;
+      _overflowPolicy = ACTIONRINGBUFFER_DROP_OLDEST;
+      _droppedFct = NULL;
+      _waitFct = NULL;
+      _blockTimeoutMillis = 0;
     #ifdef ACTIONRINGBUFFER_STAT
       _elementsMaxNb = 0; // MAX nb of elements
       _lostElementsNb = 0;    // nb of lost elements
+      _replacedElementsNb = 0; // nb of elements replaced in place
+      _rejectedElementsNb = 0; // nb of rejected elements
+      _blockedAppendsNb = 0;   // nb of appends that had to wait for free space
+      _blockTimeoutsNb = 0;    // nb of waits ended by timeout
     #endif
     };
 
 
+    // Set the overflow policy
+    // "droppedFct" (optional) is called with the overwritten data in case of DROP_OLDEST policy
+    // "waitFct" is called repeatedly while waiting for free space in case of BLOCK policy, it shall make
+    // the buffer consumer progress and return false when waiting is not possible (the data is then rejected)
+    // "blockTimeoutMillis" is the max waiting time in case of BLOCK policy
+    void SetOverflowPolicy(e_ActionRingBufferOverflowPolicy policy, void (*droppedFct)(const T&),
+                           boolean (*waitFct)(void), word blockTimeoutMillis)
+    {
+      _overflowPolicy = policy;
+      _droppedFct = droppedFct;
+      _waitFct = waitFct;
+      _blockTimeoutMillis = blockTimeoutMillis;
+    }
+
+
     // Append a data in the buffer. Append() increments the "tail"
-    // In case of buffer full, a new appended data overwrites the oldest one
-    void Append(const T& appendedData)
+    // In case of buffer full, the overflow policy is applied
+    // When "blockAllowed" is FALSE, the BLOCK policy behaves as the REJECT_NEWEST one (no waiting)
+    // Return TRUE when the data has been appended, FALSE when it has been rejected
+    boolean Append(const T& appendedData, boolean blockAllowed = true)
     {
       if (_elementsCurrentNb == _size)
-      { // buffer is already full, we overwrite the oldest data
-        IncrementHead();
+      { // buffer is already full
+        switch (_overflowPolicy)
+        {
+          case ACTIONRINGBUFFER_BLOCK :
+            if (blockAllowed && WaitForFreeSpace()) break; // some space is now available
+            // else no space freed before timeout, the new data is rejected
+            /* fall through */
+          case ACTIONRINGBUFFER_REJECT_NEWEST :
     #ifdef ACTIONRINGBUFFER_STAT
-        _lostElementsNb++;
+            _rejectedElementsNb++;
     #endif
-      }
-      else
-      { // we still have some free place
-        _elementsCurrentNb++;
+            return false;
+
+          default : // ACTIONRINGBUFFER_DROP_OLDEST, we overwrite the oldest data
+            if (_droppedFct) _droppedFct(_buffer[_head]);
+            IncrementHead();
+            _elementsCurrentNb--;
     #ifdef ACTIONRINGBUFFER_STAT
-        if (_elementsCurrentNb > _elementsMaxNb) _elementsMaxNb++;
+            _lostElementsNb++;
     #endif
+            break;
+        }
       }
+      _elementsCurrentNb++;
+    #ifdef ACTIONRINGBUFFER_STAT
+      if (_elementsCurrentNb > _elementsMaxNb) _elementsMaxNb++;
+    #endif
       _buffer[_tail] = appendedData;
       IncrementTail();
+      return true;
     }
 
 
@@ -97,6 +154,28 @@ class ActionRingBuffer {
     }
 
 
+    // Replace in place the oldest element matching the new data (match decided by "IsMatching" function)
+    // The replaced element keeps its position in the buffer
+    // Return TRUE when an element has been replaced, otherwise FALSE (nothing is appended in that case)
+    boolean Replace(const T& newData, boolean (*IsMatching)(const T&, const T&))
+    {
+      byte index = _head;
+      for (byte i = 0; i < _elementsCurrentNb; i++)
+      {
+        if (IsMatching(_buffer[index], newData))
+        {
+          _buffer[index] = newData;
+    #ifdef ACTIONRINGBUFFER_STAT
+          _replacedElementsNb++;
+    #endif
+          return true;
+        }
+        index = (index + 1) % _size;
+      }
+      return false;
+    }
+
+
     // Return the current number of data elements in the ring buffer
     byte ElementsNb(void) const { return _elementsCurrentNb; }
 
@@ -108,12 +187,37 @@ class ActionRingBuffer {
       str += "Elements Current Nb : " + String(_elementsCurrentNb,DEC);
       str += "\nElements Max Nb : " + String(_elementsMaxNb,DEC);
       str += "\nLost Elements Nb : " + String(_lostElementsNb,DEC);
+      str += "\nReplaced Elements Nb : " + String(_replacedElementsNb,DEC);
+      str += "\nRejected Elements Nb : " + String(_rejectedElementsNb,DEC);
+      str += "\nBlocked Appends Nb : " + String(_blockedAppendsNb,DEC);
+      str += "\nBlock Timeouts Nb : " + String(_blockTimeoutsNb,DEC);
       str += "\n";
     }
     #endif
 
   private :
 
+    // Wait for free space (BLOCK policy), return TRUE if some space has been freed before timeout
+    boolean WaitForFreeSpace(void)
+    {
+      if (_waitFct == NULL) return false;
+    #ifdef ACTIONRINGBUFFER_STAT
+      _blockedAppendsNb++;
+    #endif
+      word startTime = (word) millis();
+      while (_elementsCurrentNb == _size)
+      {
+        if ( ((word)((word)millis() - startTime) >= _blockTimeoutMillis) || !_waitFct() )
+        {
+    #ifdef ACTIONRINGBUFFER_STAT
+          _blockTimeoutsNb++;
+    #endif
+          return false;
+        }
+      }
+      return true;
+    }
+
     void IncrementHead(void) { _head = (_head + 1) % _size; }
     void IncrementTail(void) { _tail = (_tail + 1) % _size; }
 };
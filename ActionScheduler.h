@@ -0,0 +1,168 @@
+//    This file is part of Arduino Knx Bus Device library.
+
+//    The Arduino Knx Bus Device library allows to turn Arduino into "self-made" KNX bus device.
+//    Copyright (C) 2014 2015 2016 Franck MARINI (fm@liwan.fr)
+
+//    The Arduino Knx Bus Device library is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// File : ActionScheduler.h
+// Author : Franck Marini
+// Description : Priority scheduler of elements, with one ring buffer per KNX priority class
+// Module dependencies : ActionRingBuffer, KnxTelegram
+
+#ifndef ACTIONSCHEDULER_H
+#define ACTIONSCHEDULER_H
+
+#include "Arduino.h"
+#include "ActionRingBuffer.h"
+#include "KnxTelegram.h"
+
+// Max number of consecutive pops during which a non empty queue can be bypassed by higher priority queues
+// Once reached, the queue is served first (starvation protection)
+#define ACTIONSCHEDULER_MAX_BYPASS_NB 4
+
+// Queue ranks, from the highest priority to the lowest one
+#define ACTIONSCHEDULER_RANK_SYSTEM 0
+#define ACTIONSCHEDULER_RANK_ALARM  1
+#define ACTIONSCHEDULER_RANK_HIGH   2
+#define ACTIONSCHEDULER_RANK_NORMAL 3
+#define ACTIONSCHEDULER_RANKS_NB    4
+
+
+// The type of the contained elements and the queues sizes are defined at compile time (template)
+// "normalSize" is the size of the normal priority queue
+// "urgentSize" is the size of each of the system, alarm and high priority queues
+// Each queue behaves as an ActionRingBuffer : in case of queue full, the overflow policy is applied
+// (by default a new appended data overwrites the oldest one)
+
+template<typename T, word normalSize, word urgentSize>
+class ActionScheduler {
+     ActionRingBuffer<T, urgentSize> _urgentQueues[ACTIONSCHEDULER_RANK_NORMAL]; // system, alarm & high prio queues
+     ActionRingBuffer<T, normalSize> _normalQueue;                              // normal prio queue
+     byte _bypassNb[ACTIONSCHEDULER_RANKS_NB]; // Nb of consecutive pops each non empty queue has been bypassed
+
+  public :
+
+    // Constructor
+    ActionScheduler()
+    {
+      for (byte rank = 0; rank < ACTIONSCHEDULER_RANKS_NB; rank++) _bypassNb[rank] = 0;
+    };
+
+
+    // Set the overflow policy of all the queues (see ActionRingBuffer::SetOverflowPolicy())
+    void SetOverflowPolicy(e_ActionRingBufferOverflowPolicy policy, void (*droppedFct)(const T&),
+                           boolean (*waitFct)(void), word blockTimeoutMillis)
+    {
+      for (byte rank = 0; rank < ACTIONSCHEDULER_RANK_NORMAL; rank++)
+        _urgentQueues[rank].SetOverflowPolicy(policy, droppedFct, waitFct, blockTimeoutMillis);
+      _normalQueue.SetOverflowPolicy(policy, droppedFct, waitFct, blockTimeoutMillis);
+    }
+
+
+    // Append a data in the queue of the given priority
+    // "blockAllowed" : see ActionRingBuffer::Append()
+    // Return TRUE when the data has been appended, FALSE when it has been rejected
+    boolean Append(const T& appendedData, e_KnxPriority priority, boolean blockAllowed = true)
+    {
+      byte rank = Rank(priority);
+      if (rank == ACTIONSCHEDULER_RANK_NORMAL) return _normalQueue.Append(appendedData, blockAllowed);
+      return _urgentQueues[rank].Append(appendedData, blockAllowed);
+    }
+
+
+    // Replace in place the oldest element of the given priority queue matching the new data
+    // Return TRUE when an element has been replaced, otherwise FALSE
+    boolean Replace(const T& newData, boolean (*IsMatching)(const T&, const T&), e_KnxPriority priority)
+    {
+      byte rank = Rank(priority);
+      if (rank == ACTIONSCHEDULER_RANK_NORMAL) return _normalQueue.Replace(newData, IsMatching);
+      return _urgentQueues[rank].Replace(newData, IsMatching);
+    }
+
+
+    // Pop the next data to be treated
+    // The highest priority non empty queue is served, except when a lower priority queue
+    // has been bypassed ACTIONSCHEDULER_MAX_BYPASS_NB times (it is then served first)
+    // Return TRUE when a data is available, otherwise FALSE
+    boolean Pop(T& popData)
+    {
+      byte selectedRank = ACTIONSCHEDULER_RANKS_NB;
+      byte rank;
+
+      for (rank = 0; rank < ACTIONSCHEDULER_RANKS_NB; rank++)
+      {
+        if (!QueueElementsNb(rank)) continue;
+        if (selectedRank == ACTIONSCHEDULER_RANKS_NB) selectedRank = rank; // highest prio non empty queue
+        if (_bypassNb[rank] >= ACTIONSCHEDULER_MAX_BYPASS_NB) { selectedRank = rank; break; } // starving queue
+      }
+      if (selectedRank == ACTIONSCHEDULER_RANKS_NB) return false; // all the queues are empty
+
+      // Update the bypass counters of the non empty queues not served
+      for (rank = 0; rank < ACTIONSCHEDULER_RANKS_NB; rank++)
+      {
+        if (rank == selectedRank) _bypassNb[rank] = 0;
+        else if (QueueElementsNb(rank) && (_bypassNb[rank] < 0xFF)) _bypassNb[rank]++;
+      }
+      if (selectedRank == ACTIONSCHEDULER_RANK_NORMAL) return _normalQueue.Pop(popData);
+      return _urgentQueues[selectedRank].Pop(popData);
+    }
+
+
+    // Return the current number of data elements in all the queues
+    byte ElementsNb(void) const
+    {
+      byte elementsNb = 0;
+      for (byte rank = 0; rank < ACTIONSCHEDULER_RANKS_NB; rank++) elementsNb += QueueElementsNb(rank);
+      return elementsNb;
+    }
+
+
+    #ifdef ACTIONRINGBUFFER_STAT
+    // Return Stat information
+    void Info(String& str)
+    {
+      for (byte rank = 0; rank < ACTIONSCHEDULER_RANK_NORMAL; rank++)
+      {
+        str += "Queue rank " + String(rank,DEC) + " :\n";
+        _urgentQueues[rank].Info(str);
+      }
+      str += "Queue rank " + String(ACTIONSCHEDULER_RANK_NORMAL,DEC) + " :\n";
+      _normalQueue.Info(str);
+    }
+    #endif
+
+  private :
+
+    // Rank of the queue associated to a KNX priority
+    static byte Rank(e_KnxPriority priority)
+    {
+      switch (priority)
+      {
+        case KNX_PRIORITY_SYSTEM_VALUE : return ACTIONSCHEDULER_RANK_SYSTEM;
+        case KNX_PRIORITY_ALARM_VALUE : return ACTIONSCHEDULER_RANK_ALARM;
+        case KNX_PRIORITY_HIGH_VALUE : return ACTIONSCHEDULER_RANK_HIGH;
+        default : return ACTIONSCHEDULER_RANK_NORMAL;
+      }
+    }
+
+    byte QueueElementsNb(byte rank) const
+    {
+      if (rank == ACTIONSCHEDULER_RANK_NORMAL) return _normalQueue.ElementsNb();
+      return _urgentQueues[rank].ElementsNb();
+    }
+};
+
+#endif // ACTIONSCHEDULER_H
@@ -29,31 +29,44 @@ byte lengthCalculation(e_KnxDPT_ID dptId) {
 	return (pgm_read_byte(&KnxDPTFormatToLengthBit[ pgm_read_byte(&KnxDPTIdToFormat[dptId])] ) / 8) + 1;
 }
 
+// A given length shall fit in the inline value storage (_longValue), else the value accesses would overflow it
+static inline byte ClampLength(byte length) {
+	return (length > KNX_COM_OBJ_VALUE_MAX_SIZE + 1) ? KNX_COM_OBJ_VALUE_MAX_SIZE + 1 : length;
+}
+
 
-// Contructor
+// Contructors
 #ifdef KNX_COM_OBJ_SUPPORT_ALL_PRIORITIES
 KnxComObject::KnxComObject(word addr, e_KnxDPT_ID dptId, e_KnxPriority prio, byte indicator )
-: _addr(addr), _dptId(dptId), _indicator(indicator), _length(lengthCalculation(dptId)), _prio(prio)
+: KnxComObject(addr, dptId, prio, indicator, lengthCalculation(dptId)) {}
+
+KnxComObject::KnxComObject(word addr, e_KnxDPT_ID dptId, e_KnxPriority prio, byte indicator,
+                           const word listeningAddrs[], byte listeningAddrsNb )
+: KnxComObject(addr, dptId, prio, indicator, lengthCalculation(dptId), listeningAddrs, listeningAddrsNb) {}
+
+KnxComObject::KnxComObject(word addr, e_KnxDPT_ID dptId, e_KnxPriority prio, byte indicator, byte length,
+                           const word listeningAddrs[], byte listeningAddrsNb )
+: _addr(addr), _listeningAddrs(listeningAddrs), _listeningAddrsNb(listeningAddrs ? listeningAddrsNb : 0),
+  _dptId(dptId), _indicator(indicator), _length(ClampLength(length)), _prio(prio)
 #else
 KnxComObject::KnxComObject(word addr, e_KnxDPT_ID dptId, byte indicator )
-: _addr(addr), _dptId(dptId), _indicator(indicator), _length(lengthCalculation(dptId))
+: KnxComObject(addr, dptId, indicator, lengthCalculation(dptId)) {}
+
+KnxComObject::KnxComObject(word addr, e_KnxDPT_ID dptId, byte indicator, const word listeningAddrs[], byte listeningAddrsNb )
+: KnxComObject(addr, dptId, indicator, lengthCalculation(dptId), listeningAddrs, listeningAddrsNb) {}
+
+KnxComObject::KnxComObject(word addr, e_KnxDPT_ID dptId, byte indicator, byte length,
+                           const word listeningAddrs[], byte listeningAddrsNb )
+: _addr(addr), _listeningAddrs(listeningAddrs), _listeningAddrsNb(listeningAddrs ? listeningAddrsNb : 0),
+  _dptId(dptId), _indicator(indicator), _length(ClampLength(length))
 #endif
 {
-	if (_length <= 2) _longValue = NULL; // short value case
-	else { // long value case
-		_longValue = (byte *) malloc(_length-1);
-		for (byte i=0; i <_length-1 ; i++) _longValue[i] = 0;
-	}  
+	for (byte i=0; i < KNX_COM_OBJ_VALUE_MAX_SIZE ; i++) _longValue[i] = 0; // short and long value cases
 	if (_indicator & KNX_COM_OBJ_I_INDICATOR) _validity = false; // case of object with "InitRead" indicator
 	else _validity = true; // case of object without "InitRead" indicator
 }
 
 
-// Destructor
-KnxComObject::~KnxComObject() { if (_length > 2) free(_longValue); }
-
-
-
 // Get the com obj value (short and long value cases)
 void KnxComObject::GetValue(byte dest[]) const
 {
@@ -106,6 +119,7 @@ void KnxComObject::Info(String& str) const
 {
 byte length = GetLength();
 	str+="Addr=" + String(GetAddr(),HEX);
+	for (byte i = 0; i < GetListeningAddrsNb(); i++) str+="\nListeningAddr=" + String(GetListeningAddr(i),HEX);
 	str+="\nDPTId=" + String(GetDptId(),HEX);
 	str+="\nIndicator=" + String(GetIndicator(),HEX);
 	str+="\nLength=" + String(length,DEC);
@@ -126,9 +140,7 @@ byte length = GetLength();
 	else 
         {
 		str+="\nLongValue=";
-		byte *longValue = (byte *) malloc(length- 1);
-                GetValue(longValue);
-		for (byte i = 0; i < length-1; i++) str+=String(longValue[i], HEX)+' ';
+		for (byte i = 0; i < length-1; i++) str+=String(_longValue[i], HEX)+' ';
 	}
 }
 
@@ -32,6 +32,25 @@
 // By default, all the objects have NORMAL priority, other priorities are not supported
 // turn KNX_COM_OBJ_SUPPORT_ALL_PRIORITIES flag on to allow support of all the priorities
 // #define KNX_COM_OBJ_SUPPORT_ALL_PRIORITIES
+// By default, up to 255 com objects are supported (byte indexes)
+// turn KNX_COM_OBJ_LARGE_LIST flag on to allow up to 65535 com objects (word indexes)
+// #define KNX_COM_OBJ_LARGE_LIST
+// The com objects values are stored inline in the objects (no dynamic allocation)
+// By default, the storage fits the longest DPT of KnxDPTIdToFormat (4 bytes, e.g. U32 or F32)
+// raise KNX_COM_OBJ_VALUE_MAX_SIZE (up to 14 bytes, the max telegram payload) for longer formats
+// NB : the TX actions carry a value of the same max size (see ACTION_VALUE_MAX_SIZE)
+#define KNX_COM_OBJ_VALUE_MAX_SIZE 4
+
+// Check at compile time of the inline value storage size
+static_assert(KNX_COM_OBJ_VALUE_MAX_SIZE >= KnxDPTIdMaxValueLength(), "KNX_COM_OBJ_VALUE_MAX_SIZE too small for the DPT IDs");
+static_assert(KNX_COM_OBJ_VALUE_MAX_SIZE <= KNX_TELEGRAM_PAYLOAD_MAX_SIZE - 2, "KNX_COM_OBJ_VALUE_MAX_SIZE above the max telegram payload");
+
+// Type of the com objects indexes (and numbers)
+#ifdef KNX_COM_OBJ_LARGE_LIST
+typedef word type_ComObjectIndex;
+#else
+typedef byte type_ComObjectIndex;
+#endif
 
 // Definition of com obj indicator values
 // See "knx.org" for com obj indicators specification
@@ -58,9 +77,41 @@
 #define KNX_COM_OBJECT_OK       0
 #define KNX_COM_OBJECT_ERROR    255
 
+// Check at compile time of a com obj indicator value (B7 and B6 are reserved)
+template <byte indicator> struct KnxComObjectIndicator {
+  static_assert(!(indicator & 0xC0), "invalid com object indicator");
+  static const byte value = indicator;
+};
+
+// Declaration of a com obj with DPT and indicator checked and length resolved at compile time
+// e.g. KnxComObject KnxDevice::_comObjectsList[] = { KNX_COM_OBJECT(G_ADDR(0,0,1), KNX_DPT_1_001, COM_OBJ_SENSOR) };
+// NB : the list is attached faster when the objects are declared by increasing address (no sort needed)
+// NB : the list stays in RAM (the objects hold their value), its address order is checked at attach time only
+// KNX_COM_OBJECT_LISTENING declares a com obj listening to additional addresses ("listeningAddrs" word array)
+// e.g. const word lightAddrs[] = { G_ADDR(0,0,9), G_ADDR(0,1,0) }; // central and scene addresses
+//      KNX_COM_OBJECT_LISTENING(G_ADDR(0,0,1), lightAddrs, KNX_DPT_1_001, COM_OBJ_LOGIC_IN)
+#ifdef KNX_COM_OBJ_SUPPORT_ALL_PRIORITIES
+#define KNX_COM_OBJECT(addr, dptId, prio, indicator) \
+  KnxComObject((addr), (dptId), (prio), KnxComObjectIndicator<(indicator)>::value, KnxDPTLength<(dptId)>::value)
+#define KNX_COM_OBJECT_LISTENING(addr, listeningAddrs, dptId, prio, indicator) \
+  KnxComObject((addr), (dptId), (prio), KnxComObjectIndicator<(indicator)>::value, KnxDPTLength<(dptId)>::value, \
+               (listeningAddrs), sizeof(listeningAddrs) / sizeof(word))
+#else
+#define KNX_COM_OBJECT(addr, dptId, indicator) \
+  KnxComObject((addr), (dptId), KnxComObjectIndicator<(indicator)>::value, KnxDPTLength<(dptId)>::value)
+#define KNX_COM_OBJECT_LISTENING(addr, listeningAddrs, dptId, indicator) \
+  KnxComObject((addr), (dptId), KnxComObjectIndicator<(indicator)>::value, KnxDPTLength<(dptId)>::value, \
+               (listeningAddrs), sizeof(listeningAddrs) / sizeof(word))
+#endif
+
 
 class KnxComObject {
-	const word _addr; // Group Address value
+	const word _addr; // Group Address value (sending address, the object also listens to it)
+
+	// Additional listening Group Addresses (e.g. central or scene addresses)
+	// NB : the array is provided by the user and is not copied, it shall remain valid
+	const word *_listeningAddrs;
+	const byte _listeningAddrsNb;
 
 	const byte _dptId; // Datapoint type
 
@@ -86,23 +137,39 @@ class KnxComObject {
 			byte _notUSed;
 		};
 		// field used in case of long value (2 bytes width or more, i.e. length > 2)
-		// The data space is allocated dynamically by the constructor
-		byte *_longValue;
+		// The value is stored inline (see KNX_COM_OBJ_VALUE_MAX_SIZE)
+		byte _longValue[KNX_COM_OBJ_VALUE_MAX_SIZE];
 	};
 	
 public:
   // Constructor :
 #ifdef KNX_COM_OBJ_SUPPORT_ALL_PRIORITIES	
 	KnxComObject(word addr, e_KnxDPT_ID dptId, e_KnxPriority prio, byte indicator );
+	// with additional listening addresses
+	KnxComObject(word addr, e_KnxDPT_ID dptId, e_KnxPriority prio, byte indicator, const word listeningAddrs[], byte listeningAddrsNb );
+	// length is given (see KNX_COM_OBJECT macros)
+	// NB : a length above the inline storage (KNX_COM_OBJ_VALUE_MAX_SIZE + 1) is clamped to it
+	KnxComObject(word addr, e_KnxDPT_ID dptId, e_KnxPriority prio, byte indicator, byte length,
+	             const word listeningAddrs[] = NULL, byte listeningAddrsNb = 0 );
 #else
 	KnxComObject(word addr, e_KnxDPT_ID dptId, byte indicator );
+	// with additional listening addresses
+	KnxComObject(word addr, e_KnxDPT_ID dptId, byte indicator, const word listeningAddrs[], byte listeningAddrsNb );
+	// length is given (see KNX_COM_OBJECT macros)
+	// NB : a length above the inline storage (KNX_COM_OBJ_VALUE_MAX_SIZE + 1) is clamped to it
+	KnxComObject(word addr, e_KnxDPT_ID dptId, byte indicator, byte length,
+	             const word listeningAddrs[] = NULL, byte listeningAddrsNb = 0 );
 #endif
-  // Destructor
-	~KnxComObject();
 
   // INLINED functions (see definitions later in this file)
 	word GetAddr(void) const;
 
+	// Nb of additional listening addresses
+	byte GetListeningAddrsNb(void) const;
+
+	// Additional listening address of rank "rank" (lower than GetListeningAddrsNb())
+	word GetListeningAddr(byte rank) const;
+
 	byte GetDptId(void) const;
 
 	e_KnxPriority GetPriority(void) const;
@@ -116,6 +183,10 @@ public:
 	// Return the com obj value (short value case only)
 	byte GetValue(void) const;
 
+	// Return the pointer to the com obj value (long value case only)
+	// NB : the value can then be read in place, without copy
+	const byte* GetValuePtr(void) const;
+
 	// Update the com obj value (short value case only)
 	// Return ERROR if the com obj is long value (invalid use case), else return OK
 	byte UpdateValue(byte newVal);
@@ -150,6 +221,10 @@ public:
 // --------------- Definition of the INLINED functions -----------------
 inline word KnxComObject::GetAddr(void) const { return _addr; }
 
+inline byte KnxComObject::GetListeningAddrsNb(void) const { return _listeningAddrsNb; }
+
+inline word KnxComObject::GetListeningAddr(byte rank) const { return _listeningAddrs[rank]; }
+
 inline byte KnxComObject::GetDptId(void) const { return _dptId; }
 
 #ifdef KNX_COM_OBJ_SUPPORT_ALL_PRIORITIES	
@@ -166,6 +241,8 @@ inline byte KnxComObject::GetLength(void) const { return _length; }
 
 inline byte KnxComObject::GetValue(void) const { return _value; } 
 
+inline const byte* KnxComObject::GetValuePtr(void) const { return _longValue; }
+
 inline byte KnxComObject::UpdateValue(byte newValue)
 { if (_length > 2) return KNX_COM_OBJECT_ERROR; _value = newValue; _validity = true; return KNX_COM_OBJECT_OK; }
 
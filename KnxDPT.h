@@ -106,7 +106,7 @@ enum eKnxDPT_Format {
 
 // Definition of the length in bits according to the format
 // NB : table is stored in flash program memory to save RAM
-const byte KnxDPTFormatToLengthBit[] PROGMEM = {
+constexpr byte KnxDPTFormatToLengthBit[] PROGMEM = {
   1 , //  KNX_DPT_FORMAT_B1 = 0,
   2 , //  KNX_DPT_FORMAT_B2,
   4 , // KNX_DPT_FORMAT_B1U3
@@ -282,7 +282,7 @@ enum e_KnxDPT_ID {
 
 // Definition of the format according to the ID
 // NB : table is stored in flash program memory to save RAM
-const byte KnxDPTIdToFormat[] PROGMEM = {
+constexpr byte KnxDPTIdToFormat[] PROGMEM = {
   KNX_DPT_FORMAT_B1, //  KNX_DPT_1_001, // 1.001 B1 DPT_Switch
   KNX_DPT_FORMAT_B1, //  KNX_DPT_1_002, // 1.002 B1 DPT_Bool
   KNX_DPT_FORMAT_B1, //  KNX_DPT_1_003, // 1.003 B1 DPT_Enable
@@ -391,4 +391,26 @@ const byte KnxDPTIdToFormat[] PROGMEM = {
   KNX_DPT_FORMAT_F32 //  KNX_DPT_14_007, // 14.007 F32 DPT_Value_AngleDeg
 };
 
+// Length (calculated in the same way as telegram payload length) of a DPT known at compile time
+// The tables are read by the compiler, the value is a constant : no flash access is done at runtime
+// An unknown DPT ID leads to a compile error
+template <byte dptId> struct KnxDPTLength {
+  static_assert(dptId < sizeof(KnxDPTIdToFormat), "unknown DPT ID");
+  static const byte value = (KnxDPTFormatToLengthBit[KnxDPTIdToFormat[dptId]] / 8) + 1;
+};
+
+// Format of a DPT known at compile time (same principle as KnxDPTLength)
+template <byte dptId> struct KnxDPTFormat {
+  static_assert(dptId < sizeof(KnxDPTIdToFormat), "unknown DPT ID");
+  static const byte value = KnxDPTIdToFormat[dptId];
+};
+
+// Max value length (in bytes) of the DPT IDs, calculated at compile time
+constexpr byte KnxDPTIdMaxValueLength(byte dptId = 0, byte maxLength = 0)
+{
+  return (dptId >= sizeof(KnxDPTIdToFormat)) ? maxLength :
+         KnxDPTIdMaxValueLength(dptId + 1, ((KnxDPTFormatToLengthBit[KnxDPTIdToFormat[dptId]] / 8) > maxLength) ?
+                                           (KnxDPTFormatToLengthBit[KnxDPTIdToFormat[dptId]] / 8) : maxLength);
+}
+
 #endif // KNXDPT_H
@@ -0,0 +1,297 @@
+//    This file is part of Arduino Knx Bus Device library.
+
+//    The Arduino Knx Bus Device library allows to turn Arduino into "self-made" KNX bus device.
+//    Copyright (C) 2014 2015 2016 Franck MARINI (fm@liwan.fr)
+
+//    The Arduino Knx Bus Device library is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// File : KnxDPTBulk.cpp
+// Author : Franck Marini
+// Description : Conversion of arrays of DPT values (e.g. bus monitor captures processed by a host gateway)
+// Module dependencies : KnxDevice, KnxDPTCodec
+
+#include "KnxDPTBulk.h"
+
+// SIMD instruction set, selected at compile time (e.g. -mavx2 or -march=native on the host)
+// NB : the NEON kernels need the vector division (AArch64) and a little endian host
+#if !defined(KNXDPTBULK_NO_SIMD)
+  #if defined(__AVX2__)
+    #include <immintrin.h>
+    #define KNXDPTBULK_AVX2
+  #elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define KNXDPTBULK_SSE2
+  #elif defined(__ARM_NEON) && defined(__aarch64__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    #include <arm_neon.h>
+    #define KNXDPTBULK_NEON
+  #endif
+#endif
+
+
+// Length in bytes of a DPT value in the source array (formats of 8 bits or less take 1 byte)
+template <byte format> struct KnxDPTBulkLength {
+  static const byte value = (KnxDPTFormatToLengthBit[format] + 7) / 8;
+};
+
+
+// Scalar conversion, value per value, with the format codec
+template <byte format> static void ScalarFromDptN(const byte src[], size_t n, float out[])
+{
+  typename KnxDPTCodec<format>::type value;
+  for (size_t i = 0; i < n; i++)
+  {
+    KnxDPTCodec<format>::Decode(&src[i * KnxDPTBulkLength<format>::value], value);
+    out[i] = (float)value;
+  }
+}
+
+
+// SIMD kernels : each kernel converts the values of the array by blocks of the vector width,
+// it returns the nb of converted values (the remaining ones are converted by the scalar code)
+// The F16 value x100 (mantissa x 2^exponent) has 12 significant bits at most : it is exactly converted to float,
+// then divided by 100 as the scalar code does. The integer to float conversions round to the nearest, as the scalar ones.
+#if defined(KNXDPTBULK_AVX2)
+
+// Byte swap masks, big endian DPT values to little endian lanes
+static inline __m128i Swap16Mask(void) { return _mm_setr_epi8(1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14); }
+static inline __m256i Swap32Mask(void)
+{ return _mm256_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12, 3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12); }
+
+// F16, 8 values per block
+static size_t FromDptF16Kernel(const byte src[], size_t n, float out[])
+{
+  size_t i;
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m256i w = _mm256_cvtepu16_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&src[i * 2]), Swap16Mask()));
+    __m256i sign = _mm256_srai_epi32(_mm256_slli_epi32(w, 16), 31); // all ones when the sign bit is set
+    __m256i mantissa = _mm256_or_si256(_mm256_and_si256(w, _mm256_set1_epi32(0x07FF)),
+                                       _mm256_and_si256(sign, _mm256_set1_epi32((int)0xFFFFF800))); // 12 bits 2's complement
+    __m256i exponent = _mm256_and_si256(_mm256_srli_epi32(w, 11), _mm256_set1_epi32(0x0F));
+    __m256 valuex100 = _mm256_cvtepi32_ps(_mm256_sllv_epi32(mantissa, exponent));
+    _mm256_storeu_ps(&out[i], _mm256_div_ps(valuex100, _mm256_set1_ps(100.0f)));
+  }
+  return i;
+}
+
+// U16 and V16, 8 values per block
+static size_t FromDpt16Kernel(const byte src[], size_t n, float out[], boolean signedFormat)
+{
+  size_t i;
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m128i w = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&src[i * 2]), Swap16Mask());
+    __m256i value = signedFormat ? _mm256_cvtepi16_epi32(w) : _mm256_cvtepu16_epi32(w);
+    _mm256_storeu_ps(&out[i], _mm256_cvtepi32_ps(value));
+  }
+  return i;
+}
+
+// U32, V32 and F32, 8 values per block
+static size_t FromDpt32Kernel(const byte src[], size_t n, float out[], byte dptFormat)
+{
+  size_t i;
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m256i value = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)&src[i * 4]), Swap32Mask());
+    __m256 result;
+    if (dptFormat == KNX_DPT_FORMAT_F32) result = _mm256_castsi256_ps(value); // IEEE 754 bits
+    else if (dptFormat == KNX_DPT_FORMAT_V32) result = _mm256_cvtepi32_ps(value);
+    else // U32 : no unsigned conversion, the exact high part (16 bits x 65536) and low part are added (single rounding)
+      result = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(value, 16)), _mm256_set1_ps(65536.0f)),
+                             _mm256_cvtepi32_ps(_mm256_and_si256(value, _mm256_set1_epi32(0xFFFF))));
+    _mm256_storeu_ps(&out[i], result);
+  }
+  return i;
+}
+
+#elif defined(KNXDPTBULK_SSE2)
+
+// Byte swap of the 16 bits lanes, big endian DPT values to little endian lanes
+static inline __m128i Swap16(__m128i value) { return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8)); }
+
+// F16, 8 values per block, the mantissa is multiplied by 2^exponent built as a float (no variable shift in SSE2)
+static size_t FromDptF16Kernel(const byte src[], size_t n, float out[])
+{
+  const __m128i zero = _mm_setzero_si128();
+  size_t i;
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m128i w = Swap16(_mm_loadu_si128((const __m128i*)&src[i * 2]));
+    __m128i mantissa = _mm_or_si128(_mm_and_si128(w, _mm_set1_epi16(0x07FF)),
+                                    _mm_and_si128(_mm_srai_epi16(w, 15), _mm_set1_epi16((short)0xF800))); // 12 bits 2's complement
+    __m128i exponent = _mm_and_si128(_mm_srli_epi16(w, 11), _mm_set1_epi16(0x0F));
+    for (byte half = 0; half < 2; half++)
+    {
+      __m128i mantissa32 = _mm_srai_epi32(half ? _mm_unpackhi_epi16(mantissa, mantissa) : _mm_unpacklo_epi16(mantissa, mantissa), 16);
+      __m128i exponent32 = half ? _mm_unpackhi_epi16(exponent, zero) : _mm_unpacklo_epi16(exponent, zero);
+      __m128 power = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent32, _mm_set1_epi32(127)), 23)); // 2^exponent
+      __m128 valuex100 = _mm_mul_ps(_mm_cvtepi32_ps(mantissa32), power);
+      _mm_storeu_ps(&out[i + half * 4], _mm_div_ps(valuex100, _mm_set1_ps(100.0f)));
+    }
+  }
+  return i;
+}
+
+// U16 and V16, 8 values per block
+static size_t FromDpt16Kernel(const byte src[], size_t n, float out[], boolean signedFormat)
+{
+  const __m128i zero = _mm_setzero_si128();
+  size_t i;
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m128i w = Swap16(_mm_loadu_si128((const __m128i*)&src[i * 2]));
+    __m128i low = signedFormat ? _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16) : _mm_unpacklo_epi16(w, zero);
+    __m128i high = signedFormat ? _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16) : _mm_unpackhi_epi16(w, zero);
+    _mm_storeu_ps(&out[i], _mm_cvtepi32_ps(low));
+    _mm_storeu_ps(&out[i + 4], _mm_cvtepi32_ps(high));
+  }
+  return i;
+}
+
+// U32, V32 and F32, 4 values per block
+static size_t FromDpt32Kernel(const byte src[], size_t n, float out[], byte dptFormat)
+{
+  size_t i;
+  for (i = 0; i + 4 <= n; i += 4)
+  { // the bytes are swapped in the 16 bits lanes, then the 16 bits lanes are swapped
+    __m128i value = Swap16(_mm_loadu_si128((const __m128i*)&src[i * 4]));
+    value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+    __m128 result;
+    if (dptFormat == KNX_DPT_FORMAT_F32) result = _mm_castsi128_ps(value); // IEEE 754 bits
+    else if (dptFormat == KNX_DPT_FORMAT_V32) result = _mm_cvtepi32_ps(value);
+    else // U32 : no unsigned conversion, the exact high part (16 bits x 65536) and low part are added (single rounding)
+      result = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(value, 16)), _mm_set1_ps(65536.0f)),
+                          _mm_cvtepi32_ps(_mm_and_si128(value, _mm_set1_epi32(0xFFFF))));
+    _mm_storeu_ps(&out[i], result);
+  }
+  return i;
+}
+
+#elif defined(KNXDPTBULK_NEON)
+
+// F16, 8 values per block
+static size_t FromDptF16Kernel(const byte src[], size_t n, float out[])
+{
+  size_t i;
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    uint16x8_t w = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(&src[i * 2])));
+    int16x8_t sign = vshrq_n_s16(vreinterpretq_s16_u16(w), 15); // all ones when the sign bit is set
+    int16x8_t mantissa = vorrq_s16(vandq_s16(vreinterpretq_s16_u16(w), vdupq_n_s16(0x07FF)),
+                                   vandq_s16(sign, vdupq_n_s16((int16_t)0xF800))); // 12 bits 2's complement
+    uint16x8_t exponent = vandq_u16(vshrq_n_u16(w, 11), vdupq_n_u16(0x0F));
+    int32x4_t low = vshlq_s32(vmovl_s16(vget_low_s16(mantissa)), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(exponent))));
+    int32x4_t high = vshlq_s32(vmovl_s16(vget_high_s16(mantissa)), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(exponent))));
+    vst1q_f32(&out[i], vdivq_f32(vcvtq_f32_s32(low), vdupq_n_f32(100.0f)));
+    vst1q_f32(&out[i + 4], vdivq_f32(vcvtq_f32_s32(high), vdupq_n_f32(100.0f)));
+  }
+  return i;
+}
+
+// U16 and V16, 8 values per block
+static size_t FromDpt16Kernel(const byte src[], size_t n, float out[], boolean signedFormat)
+{
+  size_t i;
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    uint16x8_t w = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(&src[i * 2])));
+    if (signedFormat)
+    {
+      int16x8_t value = vreinterpretq_s16_u16(w);
+      vst1q_f32(&out[i], vcvtq_f32_s32(vmovl_s16(vget_low_s16(value))));
+      vst1q_f32(&out[i + 4], vcvtq_f32_s32(vmovl_s16(vget_high_s16(value))));
+    }
+    else
+    {
+      vst1q_f32(&out[i], vcvtq_f32_u32(vmovl_u16(vget_low_u16(w))));
+      vst1q_f32(&out[i + 4], vcvtq_f32_u32(vmovl_u16(vget_high_u16(w))));
+    }
+  }
+  return i;
+}
+
+// U32, V32 and F32, 4 values per block
+static size_t FromDpt32Kernel(const byte src[], size_t n, float out[], byte dptFormat)
+{
+  size_t i;
+  for (i = 0; i + 4 <= n; i += 4)
+  {
+    uint32x4_t value = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(&src[i * 4])));
+    float32x4_t result;
+    if (dptFormat == KNX_DPT_FORMAT_F32) result = vreinterpretq_f32_u32(value); // IEEE 754 bits
+    else if (dptFormat == KNX_DPT_FORMAT_V32) result = vcvtq_f32_s32(vreinterpretq_s32_u32(value));
+    else result = vcvtq_f32_u32(value);
+    vst1q_f32(&out[i], result);
+  }
+  return i;
+}
+
+#else // no SIMD instruction set, all the values are converted by the scalar code
+
+static inline size_t FromDptF16Kernel(const byte[], size_t, float[]) { return 0; }
+static inline size_t FromDpt16Kernel(const byte[], size_t, float[], boolean) { return 0; }
+static inline size_t FromDpt32Kernel(const byte[], size_t, float[], byte) { return 0; }
+
+#endif
+
+
+// Function to convert "n" consecutive DPT values to float values
+e_KnxDeviceStatus ConvertFromDptN(const byte src[], size_t n, float out[], byte dptFormat)
+{
+size_t convertedNb; // nb of values converted by the SIMD kernel
+
+  switch (dptFormat)
+  {
+    case KNX_DPT_FORMAT_B1 : ScalarFromDptN<KNX_DPT_FORMAT_B1>(src, n, out); break;
+    case KNX_DPT_FORMAT_U8 : ScalarFromDptN<KNX_DPT_FORMAT_U8>(src, n, out); break;
+    case KNX_DPT_FORMAT_V8 : ScalarFromDptN<KNX_DPT_FORMAT_V8>(src, n, out); break;
+
+    case KNX_DPT_FORMAT_F16 :
+      convertedNb = FromDptF16Kernel(src, n, out);
+      ScalarFromDptN<KNX_DPT_FORMAT_F16>(&src[convertedNb * 2], n - convertedNb, &out[convertedNb]);
+    break;
+
+    case KNX_DPT_FORMAT_U16 :
+      convertedNb = FromDpt16Kernel(src, n, out, false);
+      ScalarFromDptN<KNX_DPT_FORMAT_U16>(&src[convertedNb * 2], n - convertedNb, &out[convertedNb]);
+    break;
+
+    case KNX_DPT_FORMAT_V16 :
+      convertedNb = FromDpt16Kernel(src, n, out, true);
+      ScalarFromDptN<KNX_DPT_FORMAT_V16>(&src[convertedNb * 2], n - convertedNb, &out[convertedNb]);
+    break;
+
+    case KNX_DPT_FORMAT_U32 :
+      convertedNb = FromDpt32Kernel(src, n, out, dptFormat);
+      ScalarFromDptN<KNX_DPT_FORMAT_U32>(&src[convertedNb * 4], n - convertedNb, &out[convertedNb]);
+    break;
+
+    case KNX_DPT_FORMAT_V32 :
+      convertedNb = FromDpt32Kernel(src, n, out, dptFormat);
+      ScalarFromDptN<KNX_DPT_FORMAT_V32>(&src[convertedNb * 4], n - convertedNb, &out[convertedNb]);
+    break;
+
+    case KNX_DPT_FORMAT_F32 :
+      convertedNb = FromDpt32Kernel(src, n, out, dptFormat);
+      ScalarFromDptN<KNX_DPT_FORMAT_F32>(&src[convertedNb * 4], n - convertedNb, &out[convertedNb]);
+    break;
+
+    default : return KNX_DEVICE_ERROR;
+  }
+  return KNX_DEVICE_OK;
+}
+
+// EOF
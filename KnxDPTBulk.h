@@ -0,0 +1,43 @@
+//    This file is part of Arduino Knx Bus Device library.
+
+//    The Arduino Knx Bus Device library allows to turn Arduino into "self-made" KNX bus device.
+//    Copyright (C) 2014 2015 2016 Franck MARINI (fm@liwan.fr)
+
+//    The Arduino Knx Bus Device library is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// File : KnxDPTBulk.h
+// Author : Franck Marini
+// Description : Conversion of arrays of DPT values (e.g. bus monitor captures processed by a host gateway)
+// Module dependencies : KnxDevice, KnxDPTCodec
+
+#ifndef KNXDPTBULK_H
+#define KNXDPTBULK_H
+
+#include "Arduino.h"
+#include "KnxDevice.h"
+
+// !!!!!!!!!!!!!!! FLAG OPTIONS !!!!!!!!!!!!!!!!!
+// #define KNXDPTBULK_NO_SIMD // To be uncommented to disable the SIMD kernels (scalar conversions only)
+
+// Function to convert "n" consecutive DPT values to float values
+// Each DPT value is given as is (MSB first) and takes the format length, i.e. 1 byte for the formats of 8 bits or less
+// Supported DPT formats are B1, U8, V8, U16, V16, F16, U32, V32 and F32
+// The F16 and integer formats are converted by SIMD kernels when the build enables them (SSE2 or AVX2 on x86,
+// NEON on AArch64), the other cases and the end of the array are converted value per value.
+// The results are bit-identical to the value per value conversion (see ConvertFromDpt())
+// return KNX_DEVICE_ERROR if the format is not supported, else KNX_DEVICE_OK
+e_KnxDeviceStatus ConvertFromDptN(const byte src[], size_t n, float out[], byte dptFormat);
+
+#endif // KNXDPTBULK_H
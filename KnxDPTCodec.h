@@ -0,0 +1,262 @@
+//    This file is part of Arduino Knx Bus Device library.
+
+//    The Arduino Knx Bus Device library allows to turn Arduino into "self-made" KNX bus device.
+//    Copyright (C) 2014 2015 2016 Franck MARINI (fm@liwan.fr)
+
+//    The Arduino Knx Bus Device library is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// File : KnxDPTCodec.h
+// Author : Franck Marini
+// Description : Compile time DPT codecs : value type, decoding and encoding of each DPT format
+// Module dependencies : KnxDPT
+
+#ifndef KNXDPTCODEC_H
+#define KNXDPTCODEC_H
+
+#include "Arduino.h"
+#include "KnxDPT.h"
+
+// Range of the F16 format (DPT 9.xxx) values x100 : from -2048 x 2^15 to 2047 x 2^15
+#define KNX_DPT_F16_X100_MIN (-67108864L)
+#define KNX_DPT_F16_X100_MAX   67076096L
+
+// Value types of the composite formats
+typedef struct {
+  boolean control; // c : 0 = no control, 1 = control
+  boolean value;   // v : value of the associated B1 DPT
+} type_KnxDptB2;
+
+typedef struct {
+  boolean control; // c : 0 = decrease/up, 1 = increase/down
+  byte stepCode;   // StepCode (0..7) : 0 = break, else nb of intervals = 2^(stepCode-1)
+} type_KnxDptB1U3;
+
+typedef struct {
+  byte status; // status bits A (bit 4) to E (bit 0), 0 = set, 1 = clear
+  byte mode;   // mode bits : 001b = mode 0, 010b = mode 1, 100b = mode 2
+} type_KnxDptB5N3;
+
+typedef struct {
+  byte weekDay; // 0 = no day, 1 = Monday ... 7 = Sunday
+  byte hour;    // 0..23
+  byte minutes; // 0..59
+  byte seconds; // 0..59
+} type_KnxDptTimeOfDay;
+
+typedef struct {
+  byte day;   // 1..31
+  byte month; // 1..12
+  byte year;  // 0..99 : >= 90 means 19xx, else 20xx
+} type_KnxDptDate;
+
+// F32 format value : the IEEE 754 float bits are accessed as an integer
+typedef union {
+  float value;
+  uint32_t bits;
+} type_KnxDptF32;
+
+
+// Codec of a DPT format, resolved at compile time
+// "type" is the C value type, Decode() and Encode() convert the DPT value (payload bytes, MSB first) from/to
+// a value of that type. Encode() returns false when the value is not representable in the DPT format.
+// NB : the short formats (6 bits max) occupy the low bits of the 1st byte
+// Codecs are provided for the formats used by the DPT IDs (see KnxDPTIdToFormat), a format without codec
+// leads to a compile error
+template <byte format> struct KnxDPTCodec;
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_B1> {
+  typedef boolean type;
+  static void Decode(const byte dpt[], type& value) { value = dpt[0] & 0x01; }
+  static boolean Encode(type value, byte dpt[]) { dpt[0] = value ? 0x01 : 0x00; return true; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_B2> {
+  typedef type_KnxDptB2 type;
+  static void Decode(const byte dpt[], type& value)
+  { value.control = (dpt[0] >> 1) & 0x01; value.value = dpt[0] & 0x01; }
+  static boolean Encode(const type& value, byte dpt[])
+  { dpt[0] = (value.control ? 0x02 : 0x00) | (value.value ? 0x01 : 0x00); return true; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_B1U3> {
+  typedef type_KnxDptB1U3 type;
+  static void Decode(const byte dpt[], type& value)
+  { value.control = (dpt[0] >> 3) & 0x01; value.stepCode = dpt[0] & 0x07; }
+  static boolean Encode(const type& value, byte dpt[])
+  {
+    if (value.stepCode > 7) return false;
+    dpt[0] = (value.control ? 0x08 : 0x00) | value.stepCode;
+    return true;
+  }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_A8> {
+  typedef char type;
+  static void Decode(const byte dpt[], type& value) { value = (char)dpt[0]; }
+  static boolean Encode(type value, byte dpt[]) { dpt[0] = (byte)value; return true; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_U8> {
+  typedef byte type;
+  static void Decode(const byte dpt[], type& value) { value = dpt[0]; }
+  static boolean Encode(type value, byte dpt[]) { dpt[0] = value; return true; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_V8> {
+  typedef int8_t type;
+  static void Decode(const byte dpt[], type& value) { value = (int8_t)dpt[0]; }
+  static boolean Encode(type value, byte dpt[]) { dpt[0] = (byte)value; return true; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_B5N3> {
+  typedef type_KnxDptB5N3 type;
+  static void Decode(const byte dpt[], type& value) { value.status = dpt[0] >> 3; value.mode = dpt[0] & 0x07; }
+  static boolean Encode(const type& value, byte dpt[])
+  {
+    if ((value.status > 0x1F) || (value.mode > 0x07)) return false;
+    dpt[0] = (value.status << 3) | value.mode;
+    return true;
+  }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_U16> {
+  typedef uint16_t type;
+  static void Decode(const byte dpt[], type& value) { value = ((uint16_t)dpt[0] << 8) | dpt[1]; }
+  static boolean Encode(type value, byte dpt[]) { dpt[0] = (byte)(value >> 8); dpt[1] = (byte)value; return true; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_V16> {
+  typedef int16_t type;
+  static void Decode(const byte dpt[], type& value) { value = (int16_t)(((uint16_t)dpt[0] << 8) | dpt[1]); }
+  static boolean Encode(type value, byte dpt[]) { dpt[0] = (byte)((uint16_t)value >> 8); dpt[1] = (byte)value; return true; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_F16> {
+  typedef float type;
+
+  // Conversions between the F16 format and an integer value x100 (e.g. 2150 for 21.50), integer math only
+  // value x100 = mantissa (12 bits 2's complement) x 2^exponent
+  static void DecodeX100(const byte dpt[], long& valuex100)
+  {
+    int mantissa = ((dpt[0] & 0x07) << 8) + dpt[1];
+    if (dpt[0] & 0x80) mantissa -= 2048; // negative mantissa (sign bit weight is -2048)
+    valuex100 = (long)((unsigned long)(long)mantissa << ((dpt[0] >> 3) & 0x0F));
+  }
+
+  // The exponent is the nb of significant bits exceeding the mantissa width (count leading zeros),
+  // the mantissa is rounded to the nearest value (half away from zero)
+  // return false if the value is out of the F16 range
+  static boolean EncodeX100(long valuex100, byte dpt[])
+  {
+    boolean negativeSign = (valuex100 < 0);
+    unsigned long absoluteValue = negativeSign ? 0UL - (unsigned long)valuex100 : (unsigned long)valuex100;
+    unsigned long absoluteMantissa = absoluteValue;
+    byte exponent = 0;
+
+    if (absoluteValue > (negativeSign ? 2048UL : 2047UL))
+    { // the absolute value shifted by the exponent fits in 11 bits
+      exponent = (byte)(sizeof(unsigned long) * 8 - __builtin_clzl(absoluteValue)) - 11;
+      absoluteMantissa = RoundedShiftRight(absoluteValue, exponent);
+      if (negativeSign)
+      { // -2048 mantissa (12 bits) may be reached with a lower exponent
+        if (RoundedShiftRight(absoluteValue, exponent - 1) <= 2048)
+          absoluteMantissa = RoundedShiftRight(absoluteValue, --exponent);
+      }
+      else if (absoluteMantissa > 2047) // the rounding overflowed the mantissa range
+        absoluteMantissa = RoundedShiftRight(absoluteValue, ++exponent);
+      if (exponent > 15) return false;
+    }
+    word mantissa = negativeSign ? (word)(0 - absoluteMantissa) : (word)absoluteMantissa; // 12 bits 2's complement
+    dpt[0] = (negativeSign ? 0x80 : 0x00) | (exponent << 3) | ((mantissa >> 8) & 0x07);
+    dpt[1] = (byte)mantissa;
+    return true;
+  }
+
+  static void Decode(const byte dpt[], type& value)
+  { long valuex100; DecodeX100(dpt, valuex100); value = (float)valuex100 / 100.0f; }
+
+  static boolean Encode(type value, byte dpt[])
+  {
+    if (value != value) return false; // NaN value
+    value *= 100.0f;
+    if ((value >= 2.0e9f) || (value <= -2.0e9f)) return false; // not representable as a long value x100
+    return EncodeX100((long)(value + ((value < 0) ? -0.5f : 0.5f)), dpt); // rounded to the nearest integer
+  }
+
+  private :
+    // Shift right with rounding to the nearest value (half up)
+    static unsigned long RoundedShiftRight(unsigned long value, byte shift)
+    { return shift ? (value + (1UL << (shift - 1))) >> shift : value; }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_N3N5R2N6R2N6> {
+  typedef type_KnxDptTimeOfDay type;
+  static void Decode(const byte dpt[], type& value)
+  {
+    value.weekDay = dpt[0] >> 5; value.hour = dpt[0] & 0x1F;
+    value.minutes = dpt[1] & 0x3F; value.seconds = dpt[2] & 0x3F;
+  }
+  static boolean Encode(const type& value, byte dpt[])
+  {
+    if ((value.weekDay > 7) || (value.hour > 23) || (value.minutes > 59) || (value.seconds > 59)) return false;
+    dpt[0] = (value.weekDay << 5) | value.hour; dpt[1] = value.minutes; dpt[2] = value.seconds;
+    return true;
+  }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_R3N5R4N4R1U7> {
+  typedef type_KnxDptDate type;
+  static void Decode(const byte dpt[], type& value)
+  { value.day = dpt[0] & 0x1F; value.month = dpt[1] & 0x0F; value.year = dpt[2] & 0x7F; }
+  static boolean Encode(const type& value, byte dpt[])
+  {
+    if ((value.day < 1) || (value.day > 31) || (value.month < 1) || (value.month > 12) || (value.year > 99)) return false;
+    dpt[0] = value.day; dpt[1] = value.month; dpt[2] = value.year;
+    return true;
+  }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_U32> {
+  typedef uint32_t type;
+  static void Decode(const byte dpt[], type& value)
+  { value = ((uint32_t)dpt[0] << 24) | ((uint32_t)dpt[1] << 16) | ((uint32_t)dpt[2] << 8) | dpt[3]; }
+  static boolean Encode(type value, byte dpt[])
+  {
+    dpt[0] = (byte)(value >> 24); dpt[1] = (byte)(value >> 16); dpt[2] = (byte)(value >> 8); dpt[3] = (byte)value;
+    return true;
+  }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_V32> {
+  typedef int32_t type;
+  static void Decode(const byte dpt[], type& value)
+  { uint32_t bits; KnxDPTCodec<KNX_DPT_FORMAT_U32>::Decode(dpt, bits); value = (int32_t)bits; }
+  static boolean Encode(type value, byte dpt[]) { return KnxDPTCodec<KNX_DPT_FORMAT_U32>::Encode((uint32_t)value, dpt); }
+};
+
+template <> struct KnxDPTCodec<KNX_DPT_FORMAT_F32> {
+  typedef float type;
+  // IEEE 754 single precision, MSB first : the bytes are assembled in the float bits (no intermediate buffer)
+  static void Decode(const byte dpt[], type& value)
+  { type_KnxDptF32 f32; KnxDPTCodec<KNX_DPT_FORMAT_U32>::Decode(dpt, f32.bits); value = f32.value; }
+  static boolean Encode(type value, byte dpt[])
+  { type_KnxDptF32 f32; f32.value = value; return KnxDPTCodec<KNX_DPT_FORMAT_U32>::Encode(f32.bits, dpt); }
+};
+
+
+// Codec of a DPT ID known at compile time (e.g. KnxDPTIdCodec<KNX_DPT_9_001>::type is float)
+template <byte dptId> using KnxDPTIdCodec = KnxDPTCodec<KnxDPTFormat<dptId>::value>;
+
+#endif // KNXDPTCODEC_H
@@ -19,12 +19,16 @@
 // File : KnxDevice.cpp
 // Author : Franck Marini
 // Description : KnxDevice Abstraction Layer
-// Module dependencies : HardwareSerial, KnxTelegram, KnxComObject, KnxTpUart, ActionRingBuffer
+// Module dependencies : HardwareSerial, KnxTelegram, KnxComObject, KnxTpUart, ActionScheduler
 
 #include "KnxDevice.h"
 
 static inline word TimeDeltaWord(word now, word before) { return (word)(now - before); }
 
+// Delay till a task executed every "period" is executed again
+static inline word PeriodDelayWord(word now, word before, word period)
+{ word elapsed = TimeDeltaWord(now, before); return (elapsed > period) ? 0 : (word)(period + 1 - elapsed); }
+
 #ifdef KNXDEVICE_DEBUG_INFO
 const char KnxDevice::_debugInfoText[] = "KNXDEVICE INFO: ";
 #endif
@@ -39,10 +43,26 @@ KnxDevice::KnxDevice()
 {
   _state = INIT;
   _tpuart = NULL;
-  _txActionList= ActionRingBuffer<type_tx_action, ACTIONS_QUEUE_SIZE>();
+  _txActionList= ActionScheduler<type_tx_action, ACTIONS_QUEUE_SIZE, ACTIONS_URGENT_QUEUE_SIZE>();
+  _writeCoalescing = false;
+  _eventsBudget = KNXDEVICE_EVENTS_BUDGET;
+  _eventCallbacks = NULL;
+  _eventsBatchFct = NULL;
+  _droppedActionFct = NULL;
+  _taskOngoing = false;
+  _rxWaitingTx = false;
   _initCompleted = false;
   _initIndex = 0;
-  _rxTelegram = NULL;
+  _initReadsNb = 0;
+  _initReadGapMillis = KNXDEVICE_INIT_READ_MIN_GAP;
+  _initCompletedFct = NULL;
+  _txSlot = 0;
+  _txStaged = false;
+  _txAttempts = 0;
+  _txRetryPending = false;
+  _txMaxAttempts = KNXDEVICE_TX_MAX_ATTEMPTS;
+  _txRetryBackoffMillis = KNXDEVICE_TX_RETRY_BACKOFF;
+  _txFailureFct = NULL;
 #if defined(KNXDEVICE_DEBUG_INFO)
    _nbOfInits = 0;
    _debugStrPtr = NULL;
@@ -56,20 +76,27 @@ KnxDevice::KnxDevice()
 e_KnxDeviceStatus KnxDevice::begin(HardwareSerial& serial, word physicalAddr)
 {
   _tpuart = new KnxTpUart(serial ,physicalAddr, NORMAL);
-  _rxTelegram = &_tpuart->GetReceivedTelegram();
   // delay(10000); // Workaround for init issue with bus-powered arduino
                    // the issue is reproduced on one (faulty?) TPUART device only, so remove it for the moment.
   if(_tpuart->Reset()!= KNX_TPUART_OK)
   {
     delete(_tpuart);
     _tpuart = NULL;
-    _rxTelegram = NULL;
 #if defined(KNXDEVICE_DEBUG_INFO)
     DebugInfo("Init Error!\n");
 #endif
     return KNX_DEVICE_ERROR;
   }
   _tpuart->AttachComObjectsList(_comObjectsList, _comObjectsNb);
+  if (_tpuart->GetMaxTargetedComObjectsNb() > KNXDEVICE_EVENTS_QUEUE_SIZE)
+  { // a telegram could target more com objects than the event queue holds, its events could not be all queued
+    delete(_tpuart);
+    _tpuart = NULL;
+#if defined(KNXDEVICE_DEBUG_INFO)
+    DebugInfo("Init Error : address fan-out larger than KNXDEVICE_EVENTS_QUEUE_SIZE!\n");
+#endif
+    return KNX_DEVICE_ERROR;
+  }
   _tpuart->SetEvtCallback(&KnxDevice::GetTpUartEvents);
   _tpuart->SetAckCallback(&KnxDevice::TxTelegramAck);
   _tpuart->Init();
@@ -78,6 +105,8 @@ e_KnxDeviceStatus KnxDevice::begin(HardwareSerial& serial, word physicalAddr)
   DebugInfo("Init successful\n");
 #endif
   _lastInitTimeMillis = millis();
+  _busLoadTimeMillis = _lastInitTimeMillis;
+  _busLoadTelegramsNb = _tpuart->GetBusTelegramsNb();
   _lastTXTimeMicros = micros();
 #if defined(KNXDEVICE_DEBUG_INFO)
    _nbOfInits = 0;
@@ -90,12 +119,19 @@ e_KnxDeviceStatus KnxDevice::begin(HardwareSerial& serial, word physicalAddr)
 void KnxDevice::end()
 {
 type_tx_action action;
+type_ComObjectIndex index;
+type_tx_failure failure;
 
   _state = INIT;
   while(_txActionList.Pop(action)); // empty ring buffer
+  while(_eventList.Pop(index)); // empty events ring buffer
+  while(_txFailureList.Pop(failure)); // empty failures ring buffer
+  _txStaged = false;
+  _txRetryPending = false;
+  _rxWaitingTx = false;
   _initCompleted = false;
   _initIndex = 0;
-  _rxTelegram = NULL;
+  _initReadsNb = 0;
   delete(_tpuart);
   _tpuart = NULL;
 }
@@ -106,35 +142,12 @@ type_tx_action action;
 void KnxDevice::task(void)
 {
 type_tx_action action;
-word nowTimeMillis, nowTimeMicros;
+word nowTimeMicros;
+
+  _taskOngoing = true;
 
   // STEP 1 : Initialize Com Objects having Init Read attribute
-  if(!_initCompleted)
-  { 
-    nowTimeMillis = millis();
-    // To avoid EIB bus overloading, we wait for 500 ms between each Init read request
-    if (TimeDeltaWord(nowTimeMillis, _lastInitTimeMillis) > 500 )
-    { 
-      while ( (_initIndex< _comObjectsNb) && (_comObjectsList[_initIndex].GetValidity() )) _initIndex++;
-
-      if (_initIndex == _comObjectsNb) 
-      {
-        _initCompleted = true; // All the Com Object initialization have been performed
-      //  DebugInfo(String("KNXDevice INFO: Com Object init completed, ")+ String( _nbOfInits) + String("objs initialized.\n"));
-      }
-      else 
-      { // Com Object to be initialised has been found
-        // Add a READ request in the TX action list
-#if defined(KNXDEVICE_DEBUG_INFO) || defined(KNXDEVICE_DEBUG_INFO_VERBOSE)
-        _nbOfInits++;
-#endif
-        action.command = EIB_READ_REQUEST;
-        action.index = _initIndex;
-        _txActionList.Append(action);
-        _lastInitTimeMillis = millis(); // Update the timer
-      }
-    } 
-  }
+  if(!_initCompleted) InitTask();
 
   // STEP 2 : Get new received EIB messages from the TPUART
   // The TPUART RX task is executed every 400 us
@@ -144,60 +157,47 @@ word nowTimeMillis, nowTimeMicros;
     _lastRXTimeMicros = nowTimeMicros;
     _tpuart->RXTask();
   }
+  // All the telegrams received so far are treated (a burst is absorbed by the TPUART RX slots),
+  // as long as the event queue can absorb the resulting com object updates
+  if (_tpuart->GetReceivedTelegramsNb()) ReceivedTelegramsTask();
+
+  // STEP 3 : Prepare the next KNX message following TX actions
+  // The next telegram is built while the current one is in flight (i.e. waiting for its ACK),
+  // so that it can be sent as soon as the TPUART gets available
+  if(!_txStaged && (_state != INIT))
+  {
+    if(_txActionList.Pop(action))
+    {
+      _rxWaitingTx = false; // some room is freed in the TX action queue
+      _txStaged = BuildTelegram(action, _txTelegram[_txSlot ^ 1]);
+      _txComObjectIndex[_txSlot ^ 1] = action.index;
+    }
+  }
 
-  // STEP 3 : Send KNX messages following TX actions
+  // STEP 4 : Send the KNX message
+  // A failed telegram is sent again once its retry delay is elapsed, the staged telegram waits meanwhile
   if(_state == IDLE)
   {
-    if( _txActionList.Pop(action))
-    { // Data to be transmitted
-      switch (action.command)
+    if(_txRetryPending)
+    {
+      if ( (TimeDeltaWord((word)millis(), _txRetryTimeMillis) >= _txRetryDelayMillis)
+          && (_tpuart->SendTelegram(_txTelegram[_txSlot]) == KNX_TPUART_OK) )
       {
-        case EIB_READ_REQUEST: // a read operation of a Com Object on the EIB network is required
-          //_objectsList[action.index].CopyToTelegram(_txTelegram, KNX_COMMAND_VALUE_READ);
-          _comObjectsList[action.index].CopyAttributes(_txTelegram);
-          _txTelegram.ClearLongPayload(); _txTelegram.ClearFirstPayloadByte(); // Is it required to have a clean payload ??
-          _txTelegram.SetCommand(KNX_COMMAND_VALUE_READ);
-          _txTelegram.UpdateChecksum();
-          _tpuart->SendTelegram(_txTelegram);
-          _state = TX_ONGOING;
-          break;
-
-        case EIB_RESPONSE_REQUEST: // a response operation of a Com Object on the EIB network is required
-          _comObjectsList[action.index].CopyAttributes(_txTelegram);
-          _comObjectsList[action.index].CopyValue(_txTelegram);
-          _txTelegram.SetCommand(KNX_COMMAND_VALUE_RESPONSE);
-          _txTelegram.UpdateChecksum();
-          _tpuart->SendTelegram(_txTelegram);
-          _state = TX_ONGOING;
-          break;
-
-        case EIB_WRITE_REQUEST: // a write operation of a Com Object on the EIB network is required
-          // update the com obj value
-          if ((_comObjectsList[action.index].GetLength()) <= 2 )
-            _comObjectsList[action.index].UpdateValue(action.byteValue);
-          else
-          {
-            _comObjectsList[action.index].UpdateValue(action.valuePtr);
-            free(action.valuePtr);
-          }
-          // transmit the value through EIB network only if the Com Object has transmit attribute
-          if ( (_comObjectsList[action.index].GetIndicator()) & KNX_COM_OBJ_T_INDICATOR)
-          {
-            _comObjectsList[action.index].CopyAttributes(_txTelegram);
-            _comObjectsList[action.index].CopyValue(_txTelegram);
-            _txTelegram.SetCommand(KNX_COMMAND_VALUE_WRITE);
-            _txTelegram.UpdateChecksum();
-            _tpuart->SendTelegram(_txTelegram);
-            _state = TX_ONGOING;
-          }
-          break;
-
-        default : break;
+        _txRetryPending = false;
+        _txAttempts++;
+        _state = TX_ONGOING;
       }
     }
+    else if(_txStaged && (_tpuart->SendTelegram(_txTelegram[_txSlot ^ 1]) == KNX_TPUART_OK))
+    {
+      _txSlot ^= 1; // the staged telegram is now in flight
+      _txStaged = false;
+      _txAttempts = 1;
+      _state = TX_ONGOING;
+    }
   }
   
-  // STEP 4 : LET THE TP-UART TRANSMIT EIB MESSAGES
+  // STEP 5 : LET THE TP-UART TRANSMIT EIB MESSAGES
   // The TPUART TX task is executed every 800 us
   nowTimeMicros = micros();
   if (TimeDeltaWord(nowTimeMicros, _lastTXTimeMicros) > 800)
@@ -205,20 +205,238 @@ word nowTimeMillis, nowTimeMicros;
     _lastTXTimeMicros = nowTimeMicros;
     _tpuart->TXTask();
   }
+
+  // STEP 6 : NOTIFY THE APPLICATION
+  // knxEvents() and the TX failure callback are called at this point only, the bus related steps are never delayed
+  // by the application code
+  if (_txFailureList.ElementsNb()) TxFailuresTask();
+  if (_eventList.ElementsNb()) EventsTask();
+  _taskOngoing = false;
+}
+
+
+// Build the telegram corresponding to a TX action
+// Return false when there is no telegram to be sent
+boolean KnxDevice::BuildTelegram(const type_tx_action& action, KnxTelegram& telegram)
+{
+  telegram.ClearTelegram(); // the telegram may have been flagged as repeated by a previous sending
+  switch (action.command)
+  {
+    case EIB_READ_REQUEST: // a read operation of a Com Object on the EIB network is required
+      //_objectsList[action.index].CopyToTelegram(telegram, KNX_COMMAND_VALUE_READ);
+      _comObjectsList[action.index].CopyAttributes(telegram);
+      telegram.ClearLongPayload(); telegram.ClearFirstPayloadByte(); // Is it required to have a clean payload ??
+      telegram.SetCommand(KNX_COMMAND_VALUE_READ);
+      telegram.UpdateChecksum();
+      return true;
+
+    case EIB_RESPONSE_REQUEST: // a response operation of a Com Object on the EIB network is required
+      _comObjectsList[action.index].CopyAttributes(telegram);
+      _comObjectsList[action.index].CopyValue(telegram);
+      telegram.SetCommand(KNX_COMMAND_VALUE_RESPONSE);
+      telegram.UpdateChecksum();
+      return true;
+
+    case EIB_WRITE_REQUEST: // a write operation of a Com Object on the EIB network is required
+      // update the com obj value
+      if ((_comObjectsList[action.index].GetLength()) <= 2 )
+        _comObjectsList[action.index].UpdateValue(action.byteValue);
+      else _comObjectsList[action.index].UpdateValue(action.longValue);
+      // transmit the value through EIB network only if the Com Object has transmit attribute
+      if ( (_comObjectsList[action.index].GetIndicator()) & KNX_COM_OBJ_T_INDICATOR)
+      {
+        _comObjectsList[action.index].CopyAttributes(telegram);
+        _comObjectsList[action.index].CopyValue(telegram);
+        telegram.SetCommand(KNX_COMMAND_VALUE_WRITE);
+        telegram.UpdateChecksum();
+        return true;
+      }
+      return false;
+
+    default : return false;
+  }
+}
+
+
+// KNX device execution task, scheduling variant
+// Execute task() and return the delay (in usec) before task() has to be executed again
+unsigned long KnxDevice::scheduledTask(void)
+{
+  task();
+  return TaskDelayMicros();
+}
+
+
+// Delay (in usec) before the next required task() execution
+unsigned long KnxDevice::TaskDelayMicros(void)
+{
+unsigned long delay = KNXDEVICE_TASK_MAX_DELAY;
+unsigned long tpuartDelay;
+word nowTimeMicros = micros();
+
+  // The next telegram is prepared as soon as a TX action is pending, and sent as soon as the device is IDLE
+  if (!_txStaged && _txActionList.ElementsNb()) return 0;
+  // The pending events, sending failures and received telegrams are treated as soon as possible
+  // (except a READ waiting for room in the TX action queue, it waits for the TX progress computed below)
+  if (_eventList.ElementsNb() || _txFailureList.ElementsNb()) return 0;
+  if (_tpuart->GetReceivedTelegramsNb() && !_rxWaitingTx) return 0;
+  if ((_state == IDLE) && _txRetryPending)
+  { // a failed telegram waits for its retry delay
+    word elapsedTime = TimeDeltaWord((word)millis(), _txRetryTimeMillis);
+    if (elapsedTime >= _txRetryDelayMillis) return 0;
+    delay = (_txRetryDelayMillis - elapsedTime) * 1000UL;
+  }
+  else if (_txStaged && (_state == IDLE)) return 0;
+
+  // The TPUART RX task is executed every 400 us
+  tpuartDelay = _tpuart->GetRXTaskDelayMicros();
+  if (tpuartDelay < delay)
+  {
+    word rxDelay = PeriodDelayWord(nowTimeMicros, _lastRXTimeMicros, 400);
+    if (tpuartDelay < rxDelay) tpuartDelay = rxDelay;
+    if (tpuartDelay < delay) delay = tpuartDelay;
+  }
+
+  // The TPUART TX task is executed every 800 us
+  tpuartDelay = _tpuart->GetTXTaskDelayMicros();
+  if (tpuartDelay < delay)
+  {
+    word txDelay = PeriodDelayWord(nowTimeMicros, _lastTXTimeMicros, 800);
+    if (tpuartDelay < txDelay) tpuartDelay = txDelay;
+    if (tpuartDelay < delay) delay = tpuartDelay;
+  }
+
+  if (!_initCompleted)
+  {
+    unsigned long initDelay = InitTaskDelayMillis() * 1000UL;
+    if (initDelay < delay) delay = initDelay;
+  }
+  return delay;
+}
+
+
+// Delay (in msec) before the next required InitTask() execution
+// (new read request, read request repetition or slot release on response timeout)
+word KnxDevice::InitTaskDelayMillis(void) const
+{
+word nowTimeMillis = millis();
+word delay = 0xFFFF;
+word gapDelay, slotDelay, timeout;
+
+  if ((_initIndex == _comObjectsNb) && (!_initReadsNb)) return 0; // completion to be notified
+
+  gapDelay = PeriodDelayWord(nowTimeMillis, _lastInitTimeMillis, _initReadGapMillis - 1);
+  if ((_initIndex < _comObjectsNb) && (_initReadsNb < KNXDEVICE_INIT_READS_IN_FLIGHT)) delay = gapDelay;
+
+  for (byte i = 0; i < _initReadsNb; i++)
+  {
+    if (_comObjectsList[_initReads[i].index].GetValidity()) return 0; // response received, slot to be released
+    timeout = KNXDEVICE_INIT_READ_TIMEOUT << (_initReads[i].attempts - 1);
+    slotDelay = PeriodDelayWord(nowTimeMillis, _initReads[i].requestTimeMillis, timeout);
+    // a repeated request waits for the gap, a released slot does not
+    if ((_initReads[i].attempts < KNXDEVICE_INIT_READ_MAX_ATTEMPTS) && (slotDelay < gapDelay)) slotDelay = gapDelay;
+    if (slotDelay < delay) delay = slotDelay;
+  }
+  return delay;
+}
+
+
+// Init read phase task, called by task() till the init read phase is completed
+// Up to KNXDEVICE_INIT_READS_IN_FLIGHT read requests are kept waiting for a response.
+// To avoid EIB bus overloading, the gap between 2 read requests depends on the measured bus load.
+// Unanswered requests are repeated with a doubled timeout, up to KNXDEVICE_INIT_READ_MAX_ATTEMPTS times.
+void KnxDevice::InitTask(void)
+{
+type_tx_action action;
+word nowTimeMillis = millis();
+boolean gapElapsed;
+byte i;
+
+  // Measure the bus load every sec and deduct the gap between 2 read requests
+  if (TimeDeltaWord(nowTimeMillis, _busLoadTimeMillis) >= 1000)
+  {
+    word busTelegramsNb = _tpuart->GetBusTelegramsNb();
+    _initReadGapMillis = KNXDEVICE_INIT_READ_MIN_GAP
+                         + (busTelegramsNb - _busLoadTelegramsNb) * KNXDEVICE_INIT_READ_GAP_PER_TELEGRAM;
+    _busLoadTelegramsNb = busTelegramsNb;
+    _busLoadTimeMillis = nowTimeMillis;
+  }
+  gapElapsed = (TimeDeltaWord(nowTimeMillis, _lastInitTimeMillis) >= _initReadGapMillis);
+
+  action.command = EIB_READ_REQUEST;
+
+  // Check the read requests waiting for a response
+  i = 0;
+  while (i < _initReadsNb)
+  {
+    type_init_read& initRead = _initReads[i];
+    if ( (_comObjectsList[initRead.index].GetValidity())
+        || ( (TimeDeltaWord(nowTimeMillis, initRead.requestTimeMillis) > (KNXDEVICE_INIT_READ_TIMEOUT << (initRead.attempts - 1)))
+             && (initRead.attempts >= KNXDEVICE_INIT_READ_MAX_ATTEMPTS) ) )
+    { // the com object is initialized, or the request failed after max attempts : free the slot
+      _initReads[i] = _initReads[--_initReadsNb];
+      continue;
+    }
+    if ( gapElapsed
+        && (TimeDeltaWord(nowTimeMillis, initRead.requestTimeMillis) > (KNXDEVICE_INIT_READ_TIMEOUT << (initRead.attempts - 1))) )
+    { // response timeout, repeat the read request
+      action.index = initRead.index;
+      if (AppendAction(action, false) == KNX_DEVICE_OK)
+      {
+        initRead.attempts++;
+        initRead.requestTimeMillis = nowTimeMillis;
+        _lastInitTimeMillis = nowTimeMillis;
+        gapElapsed = false;
+      }
+    }
+    i++;
+  }
+
+  // Send a new read request if possible
+  if (gapElapsed && (_initReadsNb < KNXDEVICE_INIT_READS_IN_FLIGHT))
+  {
+    while ( (_initIndex< _comObjectsNb) && (_comObjectsList[_initIndex].GetValidity() )) _initIndex++;
+    if (_initIndex < _comObjectsNb)
+    { // Com Object to be initialised has been found
+      // Add a READ request in the TX action list
+      action.index = _initIndex;
+      if (AppendAction(action, false) == KNX_DEVICE_OK)
+      {
+#if defined(KNXDEVICE_DEBUG_INFO)
+        _nbOfInits++;
+#endif
+        _initReads[_initReadsNb].index = _initIndex;
+        _initReads[_initReadsNb].attempts = 1;
+        _initReads[_initReadsNb].requestTimeMillis = nowTimeMillis;
+        _initReadsNb++;
+        _initIndex++;
+        _lastInitTimeMillis = nowTimeMillis; // Update the timer
+      }
+    }
+  }
+
+  if ((_initIndex == _comObjectsNb) && (!_initReadsNb))
+  {
+    _initCompleted = true; // All the Com Object initialization have been performed
+#if defined(KNXDEVICE_DEBUG_INFO)
+    DebugInfo("Com Objects init completed\n");
+#endif
+    if (_initCompletedFct) _initCompletedFct();
+  }
 }
 
 
 // Quick method to read a short (<=1 byte) com object
 // NB : The returned value will be hazardous in case of use with long objects
-byte KnxDevice::read(byte objectIndex)
+byte KnxDevice::read(type_ComObjectIndex objectIndex)
 {
   return _comObjectsList[objectIndex].GetValue();
 }
 
 
 // Read an usual format com object
-// Supported DPT formats are short com object, U16, V16, U32, V32, F16 and F32 (not implemented yet)
-template <typename T>  e_KnxDeviceStatus KnxDevice::read(byte objectIndex, T& returnedValue)
+// Supported DPT formats are short com object, U16, V16, U32, V32, F16 and F32
+template <typename T>  e_KnxDeviceStatus KnxDevice::read(type_ComObjectIndex objectIndex, T& returnedValue)
 {
   // Short com object case
   if (_comObjectsList[objectIndex].GetLength()<=2)
@@ -227,105 +445,157 @@ template <typename T>  e_KnxDeviceStatus KnxDevice::read(byte objectIndex, T& re
     return KNX_DEVICE_OK;
   }
   else // long object case, let's see if we are able to translate the DPT value
-  {
-    byte dptValue[14]; // define temporary DPT value with max length
-    _comObjectsList[objectIndex].GetValue(dptValue);
-    return ConvertFromDpt(dptValue, returnedValue, pgm_read_byte(&KnxDPTIdToFormat[_comObjectsList[objectIndex].GetDptId()]));
+  { // the DPT value is converted in place (no copy)
+    return ConvertFromDpt(_comObjectsList[objectIndex].GetValuePtr(), returnedValue,
+                          pgm_read_byte(&KnxDPTIdToFormat[_comObjectsList[objectIndex].GetDptId()]));
   }
 }
 
-template e_KnxDeviceStatus KnxDevice::read <boolean>(byte objectIndex, boolean& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <unsigned char>(byte objectIndex, unsigned char& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <char>(byte objectIndex, char& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <unsigned int>(byte objectIndex, unsigned int& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <int>(byte objectIndex, int& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <unsigned long>(byte objectIndex, unsigned long& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <long>(byte objectIndex, long& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <float>(byte objectIndex, float& returnedValue);
-template e_KnxDeviceStatus KnxDevice::read <double>(byte objectIndex, double& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <boolean>(type_ComObjectIndex objectIndex, boolean& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <unsigned char>(type_ComObjectIndex objectIndex, unsigned char& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <char>(type_ComObjectIndex objectIndex, char& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <unsigned int>(type_ComObjectIndex objectIndex, unsigned int& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <int>(type_ComObjectIndex objectIndex, int& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <unsigned long>(type_ComObjectIndex objectIndex, unsigned long& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <long>(type_ComObjectIndex objectIndex, long& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <float>(type_ComObjectIndex objectIndex, float& returnedValue);
+template e_KnxDeviceStatus KnxDevice::read <double>(type_ComObjectIndex objectIndex, double& returnedValue);
 
 
 
 // Read any type of com object (DPT value provided as is)
-e_KnxDeviceStatus KnxDevice::read(byte objectIndex, byte returnedValue[])
+e_KnxDeviceStatus KnxDevice::read(type_ComObjectIndex objectIndex, byte returnedValue[])
 {
   _comObjectsList[objectIndex].GetValue(returnedValue);
   return KNX_DEVICE_OK;
 }
 
 
+// Read a F16 format com object as an integer value x100 (no floating point math)
+e_KnxDeviceStatus KnxDevice::readX100(type_ComObjectIndex objectIndex, long& returnedValuex100)
+{
+  if (pgm_read_byte(&KnxDPTIdToFormat[_comObjectsList[objectIndex].GetDptId()]) != KNX_DPT_FORMAT_F16)
+    return KNX_DEVICE_ERROR;
+  ConvertFromDptF16(_comObjectsList[objectIndex].GetValuePtr(), returnedValuex100); // converted in place (no copy)
+  return KNX_DEVICE_OK;
+}
+
+
 // Update an usual format com object
 // Supported DPT types are short com object, U16, V16, U32, V32, F16 and F32
 // The Com Object value is updated locally
 // And a telegram is sent on the EIB bus if the com object has communication & transmit attributes
-template <typename T>  e_KnxDeviceStatus KnxDevice::write(byte objectIndex, T value)
+template <typename T>  e_KnxDeviceStatus KnxDevice::write(type_ComObjectIndex objectIndex, T value)
 {
   type_tx_action action;
-  byte *destValue;
   byte length = _comObjectsList[objectIndex].GetLength();
   
   if (length <= 2 ) action.byteValue = (byte) value; // short object case
   else
   { // long object case, let's try to translate value to the com object DPT
-    destValue = (byte *) malloc(length-1); // allocate the memory for DPT
-    e_KnxDeviceStatus status = ConvertToDpt(value, destValue, pgm_read_byte(&KnxDPTIdToFormat[_comObjectsList[objectIndex].GetDptId()]));
-    if (status) // translation error
-    { 
-      free(destValue);
-      return status; // we cannot convert, we stop here
-    }
-    else  action.valuePtr = destValue;
+    // the DPT value is directly written in the action (no dynamic allocation)
+    e_KnxDeviceStatus status = ConvertToDpt(value, action.longValue, pgm_read_byte(&KnxDPTIdToFormat[_comObjectsList[objectIndex].GetDptId()]));
+    if (status) return status; // translation error, we cannot convert, we stop here
   }    
   // add WRITE action in the TX action queue
   action.command = EIB_WRITE_REQUEST;
   action.index = objectIndex;
-  _txActionList.Append(action);
-  return KNX_DEVICE_OK;
+  return AppendWriteAction(action);
 }
 
-template e_KnxDeviceStatus KnxDevice::write <boolean>(byte objectIndex, boolean value);
-template e_KnxDeviceStatus KnxDevice::write <unsigned char>(byte objectIndex, unsigned char value);
-template e_KnxDeviceStatus KnxDevice::write <char>(byte objectIndex, char value);
-template e_KnxDeviceStatus KnxDevice::write <unsigned int>(byte objectIndex, unsigned int value);
-template e_KnxDeviceStatus KnxDevice::write <int>(byte objectIndex, int value);
-template e_KnxDeviceStatus KnxDevice::write <unsigned long>(byte objectIndex, unsigned long value);
-template e_KnxDeviceStatus KnxDevice::write <long>(byte objectIndex, long value);
-template e_KnxDeviceStatus KnxDevice::write <float>(byte objectIndex, float value);
-template e_KnxDeviceStatus KnxDevice::write <double>(byte objectIndex, double value);
+template e_KnxDeviceStatus KnxDevice::write <boolean>(type_ComObjectIndex objectIndex, boolean value);
+template e_KnxDeviceStatus KnxDevice::write <unsigned char>(type_ComObjectIndex objectIndex, unsigned char value);
+template e_KnxDeviceStatus KnxDevice::write <char>(type_ComObjectIndex objectIndex, char value);
+template e_KnxDeviceStatus KnxDevice::write <unsigned int>(type_ComObjectIndex objectIndex, unsigned int value);
+template e_KnxDeviceStatus KnxDevice::write <int>(type_ComObjectIndex objectIndex, int value);
+template e_KnxDeviceStatus KnxDevice::write <unsigned long>(type_ComObjectIndex objectIndex, unsigned long value);
+template e_KnxDeviceStatus KnxDevice::write <long>(type_ComObjectIndex objectIndex, long value);
+template e_KnxDeviceStatus KnxDevice::write <float>(type_ComObjectIndex objectIndex, float value);
+template e_KnxDeviceStatus KnxDevice::write <double>(type_ComObjectIndex objectIndex, double value);
 
 
 // Update any type of com object (rough DPT value shall be provided)
 // The Com Object value is updated locally
 // And a telegram is sent on the EIB bus if the com object has communication & transmit attributes
-e_KnxDeviceStatus KnxDevice::write(byte objectIndex, byte valuePtr[])
+e_KnxDeviceStatus KnxDevice::write(type_ComObjectIndex objectIndex, byte valuePtr[])
 {
 type_tx_action action;
-byte *dptValue;
 byte length = _comObjectsList[objectIndex].GetLength();
 
   if (length>2) // check we are in long object case
   { // add WRITE action in the TX action queue
     action.command = EIB_WRITE_REQUEST;
     action.index = objectIndex;
-    dptValue = (byte *) malloc(length-1); // allocate the memory for long value
-    for (byte i=0; i<length-1; i++) dptValue[i] = valuePtr[i]; // copy value
-    action.valuePtr = (byte *) dptValue;
-    _txActionList.Append(action);
-    return KNX_DEVICE_OK;
+    for (byte i=0; i<length-1; i++) action.longValue[i] = valuePtr[i]; // copy value inline
+    return AppendWriteAction(action);
   }
   return KNX_DEVICE_ERROR;
 }
 
 
+// Update a F16 format com object with an integer value x100 (no floating point math)
+// The Com Object value is updated locally
+// And a telegram is sent on the EIB bus if the com object has communication & transmit attributes
+e_KnxDeviceStatus KnxDevice::writeX100(type_ComObjectIndex objectIndex, long valuex100)
+{
+type_tx_action action;
+
+  if (pgm_read_byte(&KnxDPTIdToFormat[_comObjectsList[objectIndex].GetDptId()]) != KNX_DPT_FORMAT_F16)
+    return KNX_DEVICE_ERROR;
+  if (ConvertToDptF16(valuex100, action.longValue)) return KNX_DEVICE_ERROR; // out of range value
+  action.command = EIB_WRITE_REQUEST;
+  action.index = objectIndex;
+  return AppendWriteAction(action);
+}
+
+
 // Com Object EIB Bus Update request
 // Request the local object to be updated with the value from the bus
 // NB : the function is asynchroneous, the update completion is notified by the knxEvents() callback
-void KnxDevice::update(byte objectIndex)
+e_KnxDeviceStatus KnxDevice::update(type_ComObjectIndex objectIndex)
 {
 type_tx_action action;
   action.command = EIB_READ_REQUEST;
   action.index = objectIndex;
-  _txActionList.Append(action); 
+  return AppendAction(action);
+}
+
+
+// Set the behavior of the TX action queue when it is full
+void KnxDevice::setOverflowPolicy(e_ActionRingBufferOverflowPolicy policy, word blockTimeoutMillis,
+                                  type_DroppedActionCallbackFctPtr droppedActionFct)
+{
+  _droppedActionFct = droppedActionFct;
+  _txActionList.SetOverflowPolicy(policy, &KnxDevice::ActionDropped, &KnxDevice::WaitForActionQueueSpace, blockTimeoutMillis);
+}
+
+
+// Set the TX retry policy
+void KnxDevice::setTxRetryPolicy(byte maxAttempts, word backoffMillis, type_TxFailureCallbackFctPtr txFailureFct)
+{
+  _txMaxAttempts = maxAttempts ? maxAttempts : 1;
+  _txRetryBackoffMillis = backoffMillis;
+  _txFailureFct = txFailureFct;
+}
+
+
+// Set the callback notifying the updates of a range of com objects (instead of knxEvents())
+// return KNX_DEVICE_ERROR in case of invalid index or allocation failure, else KNX_DEVICE_OK
+e_KnxDeviceStatus KnxDevice::setEventCallback(type_ComObjectIndex firstIndex, type_ComObjectIndex lastIndex,
+                                              type_ObjectEventCallbackFctPtr eventFct)
+{
+type_ComObjectIndex index;
+
+  if ((firstIndex > lastIndex) || (lastIndex >= _comObjectsNb)) return KNX_DEVICE_ERROR;
+  if (_eventCallbacks == NULL)
+  { // the dispatch table is allocated on the 1st registration (no memory used by the devices using knxEvents() only)
+    if (eventFct == NULL) return KNX_DEVICE_OK; // knxEvents() notification already used
+    _eventCallbacks = (type_ObjectEventCallbackFctPtr*) malloc(_comObjectsNb * sizeof(type_ObjectEventCallbackFctPtr));
+    if (_eventCallbacks == NULL) return KNX_DEVICE_ERROR;
+    for (index = 0; index < _comObjectsNb; index++) _eventCallbacks[index] = NULL;
+  }
+  for (index = firstIndex; index <= lastIndex; index++) _eventCallbacks[index] = eventFct;
+  return KNX_DEVICE_OK;
 }
 
 
@@ -334,65 +604,146 @@ boolean KnxDevice::isActive(void) const
 {
   if (_tpuart->IsActive()) return true; // TPUART is active
   if (_state == TX_ONGOING) return true; // the Device is sending a request
+  if (_txStaged || _txRetryPending) return true; // a telegram is ready to be sent
   if(_txActionList.ElementsNb()) return true; // there is at least one tx action in the queue
+  if(_eventList.ElementsNb()) return true; // there is at least one event waiting for its notification
+  if(_txFailureList.ElementsNb()) return true; // there is at least one sending failure waiting for its notification
   return false;
 }
 
 
-// Static GetTpUartEvents() function called by the KnxTpUart layer (callback)
-void KnxDevice::GetTpUartEvents(e_KnxTpUartEvent event)
+// Add an action in the TX action queue matching the com object priority
+e_KnxDeviceStatus KnxDevice::AppendAction(const type_tx_action& action, boolean blockAllowed)
+{
+  if (!_txActionList.Append(action, _comObjectsList[action.index].GetPriority(), blockAllowed))
+    return KNX_DEVICE_TX_QUEUE_FULL;
+  return KNX_DEVICE_OK;
+}
+
+
+// Add a WRITE action in the TX action queue
+// In case of write coalescing, a pending WRITE action on the same com object gets its value replaced instead
+e_KnxDeviceStatus KnxDevice::AppendWriteAction(const type_tx_action& action)
+{
+  if (_writeCoalescing
+      && _txActionList.Replace(action, &KnxDevice::IsSameWriteAction, _comObjectsList[action.index].GetPriority()))
+    return KNX_DEVICE_OK;
+  return AppendAction(action);
+}
+
+
+// Static function called by the TX action queue when an action is dropped (DROP_OLDEST overflow policy)
+void KnxDevice::ActionDropped(const type_tx_action& action)
+{
+  if (Knx._droppedActionFct) Knx._droppedActionFct(action.index);
+}
+
+
+// Static function called by the TX action queue while waiting for free space (BLOCK overflow policy)
+// Let the device progress so that the queue gets emptied
+// Return false when waiting is not possible (request made during task() execution)
+boolean KnxDevice::WaitForActionQueueSpace(void)
+{
+  if (Knx._taskOngoing || (Knx._tpuart == NULL)) return false;
+  Knx.task();
+  return true;
+}
+
+
+// Return true if both actions are WRITE actions on the same com object
+boolean KnxDevice::IsSameWriteAction(const type_tx_action& action1, const type_tx_action& action2)
+{
+  return ( (action1.command == EIB_WRITE_REQUEST) && (action2.command == EIB_WRITE_REQUEST)
+          && (action1.index == action2.index) );
+}
+
+
+// Received telegrams task, called by task() when received telegrams are pending
+// The telegrams are treated in reception order, each RX slot is released once its telegram is treated
+// The com objects updates are posted in the event queue, knxEvents() is called later (see EventsTask())
+// A telegram is left in its RX slot while the event queue cannot absorb its updates, or the TX action queue
+// its RESPONSE (it is treated by a next call)
+void KnxDevice::ReceivedTelegramsTask(void)
 {
 type_tx_action action;
-byte targetedComObjIndex; // index of the Com Object targeted by the event
+type_ComObjectIndex targetedComObjIndex; // index of the Com Object targeted by the telegram
+type_ComObjectIndex targetedComObjsNb;   // nb of Com Objects targeted by the telegram (sharing the target address)
+type_ComObjectIndex rank;
 
-  // Manage RECEIVED MESSAGES
-  if (event == TPUART_EVENT_RECEIVED_EIB_TELEGRAM)
+  while (_tpuart->GetReceivedTelegramsNb())
   {
-    Knx._state = IDLE;
-    targetedComObjIndex = Knx._tpuart->GetTargetedComObjectIndex();
-
-    switch(Knx._rxTelegram->GetCommand())
+    // NB : all the com objects sharing the target address are treated in one pass (address fan-out list)
+    KnxTelegram& rxTelegram = _tpuart->GetReceivedTelegram(); // the telegram stays in its RX slot (no copy)
+    targetedComObjsNb = _tpuart->GetTargetedComObjectsNb();
+    // the WRITE and RESPONSE telegrams post one event per targeted com object (READ ones post no event) :
+    // the telegram waits in its RX slot till the event queue has room for the whole fan-out list
+    // NB : begin() checks that every fan-out list fits in the event queue
+    if ( ((rxTelegram.GetCommand() == KNX_COMMAND_VALUE_WRITE) || (rxTelegram.GetCommand() == KNX_COMMAND_VALUE_RESPONSE))
+        && ((type_ComObjectIndex)(KNXDEVICE_EVENTS_QUEUE_SIZE - _eventList.ElementsNb()) < targetedComObjsNb) )
+      return; // not enough room in the event queue, the application has to catch up first
+
+    switch(rxTelegram.GetCommand())
     {
       case KNX_COMMAND_VALUE_READ :
 #if defined(KNXDEVICE_DEBUG_INFO)
-    	Knx.DebugInfo("READ req.\n");
+    	DebugInfo("READ req.\n");
 #endif
         // READ command coming from the bus
-        // if the Com Object has read attribute, then add RESPONSE action in the TX action list
-        if ( (_comObjectsList[targetedComObjIndex].GetIndicator()) & KNX_COM_OBJ_R_INDICATOR)
-        { // The targeted Com Object can indeed be read
-          action.command = EIB_RESPONSE_REQUEST;
-          action.index = targetedComObjIndex;
-          Knx._txActionList.Append(action);
+        // the 1st Com Object with read attribute answers : add RESPONSE action in the TX action list
+        for (rank = 0; rank < targetedComObjsNb; rank++)
+        {
+          targetedComObjIndex = _tpuart->GetTargetedComObjectIndex(rank);
+          if ( (_comObjectsList[targetedComObjIndex].GetIndicator()) & KNX_COM_OBJ_R_INDICATOR)
+          { // The targeted Com Object can indeed be read
+            action.command = EIB_RESPONSE_REQUEST;
+            action.index = targetedComObjIndex;
+            if (AppendAction(action, false) != KNX_DEVICE_OK)
+            { // TX action queue full : the telegram is left in its RX slot and treated again by a next call
+#if defined(KNXDEVICE_DEBUG_INFO)
+              DebugInfo("TX queue full, READ req. delayed\n");
+#endif
+              _rxWaitingTx = true; // no need to call task() again before a TX action is popped
+              return;
+            }
+            break;
+          }
         }
         break;
 
       case KNX_COMMAND_VALUE_RESPONSE :
 #if defined(KNXDEVICE_DEBUG_INFO)
-      	Knx.DebugInfo("RESP req.\n");
+      	DebugInfo("RESP req.\n");
 #endif
-        // RESPONSE command coming from EIB network, we update the value of the corresponding Com Object.
-        // We 1st check that the corresponding Com Object has UPDATE attribute
-        if((_comObjectsList[targetedComObjIndex].GetIndicator()) & KNX_COM_OBJ_U_INDICATOR)
+        // RESPONSE command coming from EIB network, we update the value of the corresponding Com Objects.
+        // We 1st check that each corresponding Com Object has UPDATE attribute
+        for (rank = 0; rank < targetedComObjsNb; rank++)
         {
-          _comObjectsList[targetedComObjIndex].UpdateValue(*(Knx._rxTelegram));
-          //We notify the upper layer of the update
-          knxEvents(targetedComObjIndex);
+          targetedComObjIndex = _tpuart->GetTargetedComObjectIndex(rank);
+          if((_comObjectsList[targetedComObjIndex].GetIndicator()) & KNX_COM_OBJ_U_INDICATOR)
+          {
+            _comObjectsList[targetedComObjIndex].UpdateValue(rxTelegram);
+            //We notify the upper layer of the update (deferred notification)
+            PostEvent(targetedComObjIndex);
+          }
         }
         break;
 
 
       case KNX_COMMAND_VALUE_WRITE :
 #if defined(KNXDEVICE_DEBUG_INFO)
-    	Knx.DebugInfo("WRITE req.\n");
+    	DebugInfo("WRITE req.\n");
 #endif
-        // WRITE command coming from EIB network, we update the value of the corresponding Com Object.
-        // We 1st check that the corresponding Com Object has WRITE attribute
-        if((_comObjectsList[targetedComObjIndex].GetIndicator()) & KNX_COM_OBJ_W_INDICATOR)
+        // WRITE command coming from EIB network, we update the value of the corresponding Com Objects.
+        // We 1st check that each corresponding Com Object has WRITE attribute
+        for (rank = 0; rank < targetedComObjsNb; rank++)
         {
-          _comObjectsList[targetedComObjIndex].UpdateValue(*(Knx._rxTelegram));
-          //We notify the upper layer of the update
-          knxEvents(targetedComObjIndex);
+          targetedComObjIndex = _tpuart->GetTargetedComObjectIndex(rank);
+          if((_comObjectsList[targetedComObjIndex].GetIndicator()) & KNX_COM_OBJ_W_INDICATOR)
+          {
+            _comObjectsList[targetedComObjIndex].UpdateValue(rxTelegram);
+            //We notify the upper layer of the update (deferred notification)
+            PostEvent(targetedComObjIndex);
+          }
         }
         break;
 
@@ -400,7 +751,62 @@ byte targetedComObjIndex; // index of the Com Object targeted by the event
 
       default : break; // not supposed to happen
     }
+    _tpuart->ReleaseReceivedTelegram(); // the RX slot is available again
   }
+}
+
+
+// Add a com object in the event queue
+// The notification of a com object already waiting for it is not repeated : knxEvents() reads the latest value anyway
+void KnxDevice::PostEvent(type_ComObjectIndex index)
+{
+  if (!_eventList.Replace(index, &KnxDevice::IsSameEvent)) _eventList.Append(index);
+}
+
+
+// Events task, called by task() when events are pending
+// The application is notified in the order of the updates, up to the events budget :
+// the com objects with own event callback are notified directly (dispatch table), the other ones are notified
+// by a single batch callback call when it is set, else by knxEvents()
+void KnxDevice::EventsTask(void)
+{
+type_ComObjectIndex index;
+type_ComObjectIndex batchIndexes[KNXDEVICE_EVENTS_QUEUE_SIZE];
+byte batchIndexesNb = 0;
+byte eventsNb = 0;
+
+  // NB : no event is posted during the dispatch, so the nb of popped events is lower than the queue size
+  while ( ((_eventsBudget == 0) || (eventsNb < _eventsBudget)) && _eventList.Pop(index) )
+  {
+    eventsNb++;
+    if (_eventCallbacks && _eventCallbacks[index]) _eventCallbacks[index](index);
+    else if (_eventsBatchFct) batchIndexes[batchIndexesNb++] = index;
+    else knxEvents(index);
+  }
+  if (batchIndexesNb) _eventsBatchFct(batchIndexes, batchIndexesNb);
+}
+
+
+// Sending failures task, called by task() when failures are pending
+void KnxDevice::TxFailuresTask(void)
+{
+type_tx_failure failure;
+
+  while (_txFailureList.Pop(failure)) if (_txFailureFct) _txFailureFct(failure.index, failure.cause);
+}
+
+
+// Return true if both event queue elements refer to the same com object
+boolean KnxDevice::IsSameEvent(const type_ComObjectIndex& index1, const type_ComObjectIndex& index2)
+{
+  return (index1 == index2);
+}
+
+
+// Static GetTpUartEvents() function called by the KnxTpUart layer (callback)
+void KnxDevice::GetTpUartEvents(e_KnxTpUartEvent event)
+{
+  // NB : the RECEIVED MESSAGES are kept in the TPUART RX slots, they are treated by task() (see ReceivedTelegramsTask())
 
   // Manage RESET events
   if (event == TPUART_EVENT_RESET)
@@ -416,60 +822,173 @@ byte targetedComObjIndex; // index of the Com Object targeted by the event
 void KnxDevice::TxTelegramAck(e_TpUartTxAck value)
 {
   Knx._state = IDLE;
-#ifdef KNXDevice_DEBUG
-  if(value != ACK_RESPONSE)
+  if (value == ACK_RESPONSE) return;
+
+#if defined(KNXDEVICE_DEBUG_INFO)
+  switch(value)
   {
-    switch(value)
-    {  
-      case NACK_RESPONSE: DebugInfo("NACK RESPONSE!!\n"); break;
-      case NO_ANSWER_TIMEOUT: DebugInfo("NO ANSWER TIMEOUT RESPONSE!!\n");; break;
-      case TPUART_RESET_RESPONSE: DebugInfo("RESET RESPONSE!!\n");; break;
-    }
+    case NACK_RESPONSE: Knx.DebugInfo("NACK RESPONSE!!\n"); break;
+    case NO_ANSWER_TIMEOUT: Knx.DebugInfo("NO ANSWER TIMEOUT RESPONSE!!\n"); break;
+    case TPUART_RESET_RESPONSE: Knx.DebugInfo("RESET RESPONSE!!\n"); break;
+    default : break;
+  }
+#endif
+
+  if (Knx._txAttempts < Knx._txMaxAttempts)
+  { // the telegram is sent again, flagged as repeated, after the backoff delay
+    KnxTelegram& telegram = Knx._txTelegram[Knx._txSlot];
+    telegram.SetRepeated();
+    telegram.UpdateChecksum();
+    Knx._txRetryPending = true;
+    Knx._txRetryTimeMillis = millis();
+    Knx._txRetryDelayMillis = Knx._txRetryBackoffMillis << (Knx._txAttempts - 1);
+  }
+  else if (Knx._txFailureFct)
+  { // all the attempts failed, the application is notified later by task() (see TxFailuresTask())
+    type_tx_failure failure;
+    failure.index = Knx._txComObjectIndex[Knx._txSlot];
+    failure.cause = value;
+    Knx._txFailureList.Append(failure); // DROP_OLDEST policy in the unlikely case of queue full
   }
-#endif // KNXDevice_DEBUG
-} 
+}
+
+
+// Conversions between a standard C type value and an integer value x100 (F16 format)
+// The integer types conversions use integer math only, the float type ones use single precision math only
+// The values too large for a long value x100 are saturated, and so are the NaN values (the F16 conversion then
+// reports the error)
+#define KNX_DPT_X100_SATURATION_MAX   0x7FFFFFFFL
+#define KNX_DPT_X100_SATURATION_MIN (-0x7FFFFFFFL - 1)
+
+template <typename T> static inline long ValueToX100(T value)
+{
+  if ((value > 0) && ((unsigned long)value > KNX_DPT_X100_SATURATION_MAX / 100)) return KNX_DPT_X100_SATURATION_MAX;
+  if ((long)value < KNX_DPT_X100_SATURATION_MIN / 100) return KNX_DPT_X100_SATURATION_MIN; // large positive values excluded above
+  return (long)value * 100;
+}
+
+static inline long ValueToX100(float value)
+{
+  if (value != value) return KNX_DPT_X100_SATURATION_MAX; // NaN value, the long conversion would be undefined
+  value *= 100.0f;
+  if (value >= 2.0e9f) return KNX_DPT_X100_SATURATION_MAX;
+  if (value <= -2.0e9f) return KNX_DPT_X100_SATURATION_MIN;
+  return (long)(value + ((value < 0) ? -0.5f : 0.5f)); // rounded to the nearest integer
+}
+
+static inline long ValueToX100(double value)
+{
+  if (value != value) return KNX_DPT_X100_SATURATION_MAX; // NaN value, the long conversion would be undefined
+  value *= 100.0;
+  if (value >= 2.0e9) return KNX_DPT_X100_SATURATION_MAX;
+  if (value <= -2.0e9) return KNX_DPT_X100_SATURATION_MIN;
+  return (long)(value + ((value < 0) ? -0.5 : 0.5)); // rounded to the nearest integer
+}
+
+// Range of an integer result type
+template <typename T> struct IntegerRange {
+  static const boolean isSigned = ((T)(-1) < (T)0);
+  static const T max = isSigned ? (T)(((unsigned long)1 << (sizeof(T) * 8 - 1)) - 1) : (T)(-1);
+  static const T min = isSigned ? (T)(-max - 1) : (T)0;
+};
+
+// Conversions of a decoded value to the result type
+// An integer result is saturated to the range of its type (a NaN value gives 0), the float types results are not
+template <typename T> static inline void SignedToValue(long value, T& result)
+{
+  if (value < 0) result = (IntegerRange<T>::isSigned && (value >= (long)IntegerRange<T>::min)) ? (T)value : IntegerRange<T>::min;
+  else result = ((unsigned long)value > (unsigned long)IntegerRange<T>::max) ? IntegerRange<T>::max : (T)value;
+}
+
+static inline void SignedToValue(long value, float& result) { result = (float)value; }
+
+static inline void SignedToValue(long value, double& result) { result = (double)value; }
+
+template <typename T> static inline void UnsignedToValue(unsigned long value, T& result)
+{ result = (value > (unsigned long)IntegerRange<T>::max) ? IntegerRange<T>::max : (T)value; }
+
+static inline void UnsignedToValue(unsigned long value, float& result) { result = (float)value; }
+
+static inline void UnsignedToValue(unsigned long value, double& result) { result = (double)value; }
+
+template <typename T> static inline void FloatToValue(float value, T& result)
+{
+  if (value != value) result = 0; // NaN
+  else if (value <= (float)IntegerRange<T>::min) result = IntegerRange<T>::min;
+  else if (value >= (float)IntegerRange<T>::max) result = IntegerRange<T>::max;
+  else result = (T)value; // truncated
+}
+
+static inline void FloatToValue(float value, float& result) { result = value; }
+
+static inline void FloatToValue(float value, double& result) { result = (double)value; }
+
+template <typename T> static inline void X100ToValue(long valuex100, T& value) { SignedToValue(valuex100 / 100, value); }
+
+static inline void X100ToValue(long valuex100, float& value) { value = (float)valuex100 / 100.0f; }
+
+static inline void X100ToValue(long valuex100, double& value) { value = (double)valuex100 / 100.0; }
 
 
 // Functions to convert a standard C type to a DPT format
-// NB : only the usual DPT formats are supported (U16, V16, U32, V32, F16 and F32 (not yet implemented)
+// NB : only the usual DPT formats are supported (U16, V16, U32, V32, F16 and F32)
 template <typename T> e_KnxDeviceStatus ConvertFromDpt(const byte dptOriginValue[], T& resultValue, byte dptFormat)
 {
   switch (dptFormat)
   {
+    // the value is decoded with its signedness (see KnxDPTCodec.h), then converted to the result type
     case KNX_DPT_FORMAT_U16:
+    {
+      KnxDPTCodec<KNX_DPT_FORMAT_U16>::type value;
+      KnxDPTCodec<KNX_DPT_FORMAT_U16>::Decode(dptOriginValue, value);
+      UnsignedToValue(value, resultValue);
+      return KNX_DEVICE_OK;
+    }
+    break;
+
     case KNX_DPT_FORMAT_V16:
-      resultValue = (T)((unsigned int)dptOriginValue[0] << 8);
-      resultValue += (T)(dptOriginValue[1]);
+    {
+      KnxDPTCodec<KNX_DPT_FORMAT_V16>::type value;
+      KnxDPTCodec<KNX_DPT_FORMAT_V16>::Decode(dptOriginValue, value);
+      SignedToValue(value, resultValue);
       return KNX_DEVICE_OK;
+    }
     break;
 
     case KNX_DPT_FORMAT_U32:
+    {
+      KnxDPTCodec<KNX_DPT_FORMAT_U32>::type value;
+      KnxDPTCodec<KNX_DPT_FORMAT_U32>::Decode(dptOriginValue, value);
+      UnsignedToValue(value, resultValue);
+      return KNX_DEVICE_OK;
+    }
+    break;
+
     case KNX_DPT_FORMAT_V32:
-      resultValue = (T)((unsigned long)dptOriginValue[0] << 24);
-      resultValue += (T)((unsigned long)dptOriginValue[1] << 16);
-      resultValue += (T)((unsigned long)dptOriginValue[2] << 8);
-      resultValue += (T)(dptOriginValue[3]);
+    {
+      KnxDPTCodec<KNX_DPT_FORMAT_V32>::type value;
+      KnxDPTCodec<KNX_DPT_FORMAT_V32>::Decode(dptOriginValue, value);
+      SignedToValue(value, resultValue);
       return KNX_DEVICE_OK;
+    }
     break;
 
     case KNX_DPT_FORMAT_F16 :
-    {
-      // Get the DPT sign, mantissa and exponent
-      int signMultiplier = (dptOriginValue[0] & 0x80) ? -1 : 1;
-      word absoluteMantissa = dptOriginValue[1] + ((dptOriginValue[0]&0x07)<<8);
-      if (signMultiplier == -1) 
-      { // Calculate absolute mantissa value in case of negative mantissa
-        // Abs = 2's complement + 1
-        absoluteMantissa = ((~absoluteMantissa)& 0x07FF ) + 1;
-      }
-      byte exponent = (dptOriginValue[0]&0x78)>>3;
-      resultValue = (T)(0.01 * ((long)absoluteMantissa << exponent) * signMultiplier);
+    { // integer decoding, the value x100 is then converted to the result type
+      long valuex100;
+      ConvertFromDptF16(dptOriginValue, valuex100);
+      X100ToValue(valuex100, resultValue);
       return KNX_DEVICE_OK;
     }
     break;
 
     case KNX_DPT_FORMAT_F32 :
-      return KNX_DEVICE_NOT_IMPLEMENTED;
+    { // IEEE 754 single precision
+      float value;
+      KnxDPTCodec<KNX_DPT_FORMAT_F32>::Decode(dptOriginValue, value);
+      FloatToValue(value, resultValue);
+      return KNX_DEVICE_OK;
+    }
     break;
 
     default :
@@ -489,7 +1008,7 @@ template e_KnxDeviceStatus ConvertFromDpt <double>(const byte dptOriginValue[],
 
 
 // Functions to convert a standard C type to a DPT format
-// NB : only the usual DPT formats are supported (U16, V16, U32, V32, F16 and F32 (not yet implemented)
+// NB : only the usual DPT formats are supported (U16, V16, U32, V32, F16 and F32)
 template <typename T> e_KnxDeviceStatus ConvertToDpt(T originValue, byte dptDestValue[], byte dptFormat)
 {
   switch (dptFormat)
@@ -511,38 +1030,14 @@ template <typename T> e_KnxDeviceStatus ConvertToDpt(T originValue, byte dptDest
     break;
 
     case KNX_DPT_FORMAT_F16 :
-    {
-      long longValuex100 = (long)(100.0 * originValue);
-      boolean negativeSign = (longValuex100 & 0x80000000)? true : false;
-      byte exponent = 0;
-      byte round = 0;
-
-      if (negativeSign)
-      {
-        while(longValuex100 < (long)(-2048)) 
-        {
-           exponent++; round = (byte)(longValuex100) & 1 ; longValuex100>>=1; longValuex100|=0x80000000;
-        }
-      }
-      else
-      {
-        while(longValuex100 > (long)(2047)) 
-        {
-          exponent++; round = (byte)(longValuex100) & 1 ; longValuex100>>=1;
-        }
-
-      }
-      if (round) longValuex100++;
-      dptDestValue[1] = (byte)longValuex100;
-      dptDestValue[0] = (byte)(longValuex100>>8) & 0x7 ;
-      dptDestValue[0] += exponent<<3;
-      if (negativeSign) dptDestValue[0] += 0x80;
-      return KNX_DEVICE_OK;
-    }
+      // the value is converted to an integer value x100, then encoded with integer math
+      return ConvertToDptF16(ValueToX100(originValue), dptDestValue);
     break;
 
     case KNX_DPT_FORMAT_F32 :
-      return KNX_DEVICE_NOT_IMPLEMENTED;
+      // IEEE 754 single precision (see KnxDPTCodec.h)
+      KnxDPTCodec<KNX_DPT_FORMAT_F32>::Encode((float)originValue, dptDestValue);
+      return KNX_DEVICE_OK;
     break;
 
     default :
@@ -560,5 +1055,17 @@ template e_KnxDeviceStatus ConvertToDpt <long>(long, byte dptDestValue[], byte d
 template e_KnxDeviceStatus ConvertToDpt <float>(float, byte dptDestValue[], byte dptFormat);
 template e_KnxDeviceStatus ConvertToDpt <double>(double, byte dptDestValue[], byte dptFormat);
 
+
+// Functions to convert between the F16 format (DPT 9.xxx) and an integer value x100 (see KnxDPTCodec.h)
+void ConvertFromDptF16(const byte dptOriginValue[], long& valuex100)
+{
+  KnxDPTCodec<KNX_DPT_FORMAT_F16>::DecodeX100(dptOriginValue, valuex100);
+}
+
+e_KnxDeviceStatus ConvertToDptF16(long valuex100, byte dptDestValue[])
+{
+  return KnxDPTCodec<KNX_DPT_FORMAT_F16>::EncodeX100(valuex100, dptDestValue) ? KNX_DEVICE_OK : KNX_DEVICE_ERROR;
+}
+
 // EOF
 
@@ -19,7 +19,7 @@
 // File : KnxDevice.h
 // Author : Franck Marini
 // Description : KnxDevice Abstraction Layer
-// Module dependencies : HardwareSerial, KnxTelegram, KnxComObject, KnxTpUart, ActionRingBuffer
+// Module dependencies : HardwareSerial, KnxTelegram, KnxComObject, KnxTpUart, ActionScheduler, KnxDPTCodec
 
 #ifndef KNXDEVICE_H
 #define KNXDEVICE_H
@@ -27,8 +27,9 @@
 #include "Arduino.h"
 #include "KnxTelegram.h"
 #include "KnxComObject.h"
-#include "ActionRingBuffer.h"
+#include "ActionScheduler.h"
 #include "KnxTpUart.h"
+#include "KnxDPTCodec.h"
 
 // !!!!!!!!!!!!!!! FLAG OPTIONS !!!!!!!!!!!!!!!!!
 // DEBUG :
@@ -37,21 +38,53 @@
 // Values returned by the KnxDevice member functions :
 enum e_KnxDeviceStatus {
   KNX_DEVICE_OK = 0,
+  KNX_DEVICE_TX_QUEUE_FULL = 253,
   KNX_DEVICE_NOT_IMPLEMENTED = 254,
   KNX_DEVICE_ERROR = 255
 };
 
 // Macro functions for conversion of physical and 2/3 level group addresses
-inline word P_ADDR(byte area, byte line, byte busdevice)
+// NB : the functions are constexpr, the addresses of a com objects list are compile time constants
+constexpr word P_ADDR(byte area, byte line, byte busdevice)
 { return (word) ( ((area&0xF)<<12) + ((line&0xF)<<8) + busdevice ); }
 
-inline word G_ADDR(byte maingrp, byte midgrp, byte subgrp)
+constexpr word G_ADDR(byte maingrp, byte midgrp, byte subgrp)
 { return (word) ( ((maingrp&0x1F)<<11) + ((midgrp&0x7)<<8) + subgrp ); }
 
-inline word G_ADDR(byte maingrp, byte subgrp)
+constexpr word G_ADDR(byte maingrp, byte subgrp)
 { return (word) ( ((maingrp&0x1F)<<11) + subgrp ); }
 
-#define ACTIONS_QUEUE_SIZE 16
+// Sizes of the TX action queues : one queue per KNX priority class (system, alarm, high, normal)
+#define ACTIONS_QUEUE_SIZE 16 // normal priority queue
+#ifdef KNX_COM_OBJ_SUPPORT_ALL_PRIORITIES
+#define ACTIONS_URGENT_QUEUE_SIZE 4 // each of the system, alarm & high priority queues
+#else
+#define ACTIONS_URGENT_QUEUE_SIZE 1 // all the objects have normal priority, the other queues are not used
+#endif
+
+// Max width of a com object value carried by a TX action (same as the com object inline storage)
+#define ACTION_VALUE_MAX_SIZE KNX_COM_OBJ_VALUE_MAX_SIZE
+
+// Init read phase : at start-up, the Com Objects with Init Read attribute get their value read on the bus
+#define KNXDEVICE_INIT_READS_IN_FLIGHT       4    // Max nb of init read requests waiting for a response
+#define KNXDEVICE_INIT_READ_MAX_ATTEMPTS     3    // Max nb of read requests sent per com object
+#define KNXDEVICE_INIT_READ_TIMEOUT          1000 // Response timeout (msec) of the 1st request, doubled on each retry
+#define KNXDEVICE_INIT_READ_MIN_GAP          20   // Min gap (msec) between 2 init read requests, when the bus is idle
+#define KNXDEVICE_INIT_READ_GAP_PER_TELEGRAM 5    // Gap increase (msec) per telegram seen on the bus during the last second
+
+// TX retries : a telegram not acknowledged (NACK, no answer or TPUART reset) is sent again with its repeat flag set
+#define KNXDEVICE_TX_MAX_ATTEMPTS      3  // Default max nb of sendings of a telegram (1 means no retry)
+#define KNXDEVICE_TX_RETRY_BACKOFF     50 // Default delay (msec) before the 1st retry, doubled on each new retry
+#define KNXDEVICE_TX_FAILURES_QUEUE_SIZE 4 // Max nb of sending failures waiting for their notification
+
+// Events : knxEvents() is never called from the bus related steps, the com objects updated by the bus are queued
+// and the application is notified at the end of task(), up to a budget of knxEvents() calls per task() execution
+#define KNXDEVICE_EVENTS_QUEUE_SIZE 16 // Max nb of com objects waiting for their knxEvents() notification
+                                       // (not lower than the nb of com objects sharing a group address, checked by begin())
+#define KNXDEVICE_EVENTS_BUDGET     4  // Default max nb of knxEvents() calls per task() execution
+
+// Max delay (usec) returned by scheduledTask(), when no deadline is pending
+#define KNXDEVICE_TASK_MAX_DELAY 1000000UL
 
 // KnxDevice internal state
 enum e_KnxDeviceState {
@@ -69,52 +102,123 @@ enum e_KnxDeviceTxActionType {
 
 struct struct_tx_action{
   e_KnxDeviceTxActionType command; // Action type to be performed
-  byte index; // Index of the involved ComObject
+  type_ComObjectIndex index; // Index of the involved ComObject
   union { // Value
     // Field used in case of short value (value width <= 1 byte)
-    struct {
-      byte byteValue;
-      byte notUsed;
-    };
-    byte *valuePtr; // Field used in case of long value (width > 1 byte), space is allocated dynamically
+    byte byteValue;
+    // Field used in case of long value (width > 1 byte), the value is stored inline (no dynamic allocation)
+    byte longValue[ACTION_VALUE_MAX_SIZE];
   };
 };// type_tx_action;
 
 typedef struct struct_tx_action type_tx_action;
 
+// Init read request waiting for a response
+struct struct_init_read {
+  type_ComObjectIndex index; // Index of the ComObject being initialized
+  byte attempts;          // Nb of read requests sent
+  word requestTimeMillis; // Time (in msec) of the last read request
+};
+
+typedef struct struct_init_read type_init_read;
+
+// Telegram sending failure waiting for its notification (see setTxRetryPolicy())
+struct struct_tx_failure {
+  type_ComObjectIndex index; // Index of the ComObject involved in the telegram
+  e_TpUartTxAck cause;       // Cause of the last failure
+};
+
+typedef struct struct_tx_failure type_tx_failure;
+
+// Typedef for the callback function notifying the completion of the init read phase
+typedef void (*type_InitCompletedCallbackFctPtr) (void);
+
+// Typedef for the callback function notifying a TX action dropped from the queue (DROP_OLDEST overflow policy)
+// The parameter is the index of the com object involved in the dropped action
+typedef void (*type_DroppedActionCallbackFctPtr) (type_ComObjectIndex);
+
+// Typedef for the callback function notifying a telegram sending failure (all the attempts failed)
+// The parameters are the index of the com object involved in the telegram and the cause of the last failure
+typedef void (*type_TxFailureCallbackFctPtr) (type_ComObjectIndex, e_TpUartTxAck);
+
+// Typedef for the callback function notifying the update of a com object by the bus (see setEventCallback())
+// The parameter is the index of the updated com object
+typedef void (*type_ObjectEventCallbackFctPtr) (type_ComObjectIndex);
+
+// Typedef for the callback function notifying the update of several com objects at once (see setEventsBatchCallback())
+// The parameters are the indexes of the updated com objects and their nb
+typedef void (*type_ObjectEventsBatchCallbackFctPtr) (const type_ComObjectIndex[], byte);
+
 
 // Callback function to catch and treat KNX events
 // The definition shall be provided by the end-user
-extern void knxEvents(byte);
+// NB : the parameter type is byte, or word when KNX_COM_OBJ_LARGE_LIST flag is on (see KnxComObject.h)
+extern void knxEvents(type_ComObjectIndex);
 
 
 // --------------- Definition of the functions for DPT translation --------------------
 // Functions to convert a DPT format to a standard C type
 // NB : only the usual DPT formats are supported (U16, V16, U32, V32, F16 and F32)
+// NB : the F32 format (DPT 14.xxx) is converted through a single precision float, whatever the type
+// NB : the value is saturated to the range of an integer type (e.g. a negative V16 value gives 0 in an unsigned type,
+// a F32 NaN value gives 0), the F16 and F32 values are truncated toward zero
 template <typename T> e_KnxDeviceStatus ConvertFromDpt(const byte dpt[], T& result, byte dptFormat);
 
 // Functions to convert a standard C type to a DPT format
 // NB : only the usual DPT formats are supported (U16, V16, U32, V32, F16 and F32)
+// NB : the F32 format (DPT 14.xxx) is converted through a single precision float, whatever the type
 template <typename T> e_KnxDeviceStatus ConvertToDpt(T value, byte dpt[], byte dptFormat);
 
+// Functions to convert between the F16 format (DPT 9.xxx) and an integer value x100 (e.g. 2150 for 21.50)
+// (see KNX_DPT_F16_X100_MIN/MAX range in KnxDPTCodec.h)
+// The conversions use integer math only, the exponent is found with a count leading zeros operation
+// and the mantissa is rounded to the nearest value (half away from zero)
+// ConvertToDptF16() returns KNX_DEVICE_ERROR when the value is out of the F16 range
+void ConvertFromDptF16(const byte dpt[], long& valuex100);
+e_KnxDeviceStatus ConvertToDptF16(long valuex100, byte dpt[]);
+
 
 class KnxDevice {
     static KnxComObject _comObjectsList[];          // List of Com Objects attached to the KNX Device
                                                     // The definition shall be provided by the end-user
-    static const byte _comObjectsNb;                // Nb of attached Com Objects
+    static const type_ComObjectIndex _comObjectsNb; // Nb of attached Com Objects
                                                     // The value shall be provided by the end-user
     e_KnxDeviceState _state;                        // Current KnxDevice state
     KnxTpUart *_tpuart;                             // TPUART associated to the KNX Device
-    ActionRingBuffer<type_tx_action, ACTIONS_QUEUE_SIZE> _txActionList; // Queue of transmit actions to be performed
+    ActionScheduler<type_tx_action, ACTIONS_QUEUE_SIZE, ACTIONS_URGENT_QUEUE_SIZE> _txActionList; // Queues of transmit actions to be performed
+    boolean _writeCoalescing;                       // True when a new write replaces the pending write of the same com object
+    ActionRingBuffer<type_ComObjectIndex, KNXDEVICE_EVENTS_QUEUE_SIZE> _eventList; // Com objects waiting for their knxEvents() notification
+    byte _eventsBudget;                             // Max nb of knxEvents() calls per task() execution (0 = no limit)
+    type_ObjectEventCallbackFctPtr *_eventCallbacks;      // Dispatch table : event callback of each com object (NULL = knxEvents())
+    type_ObjectEventsBatchCallbackFctPtr _eventsBatchFct; // Callback notifying the updated com objects without own callback, by batch
+    type_DroppedActionCallbackFctPtr _droppedActionFct; // Callback notifying the dropped actions (DROP_OLDEST overflow policy)
+    boolean _taskOngoing;                           // True while task() is being executed
+    boolean _rxWaitingTx;                           // True when a received READ waits for room in the TX action queue
     boolean _initCompleted;                         // True when all the Com Object with Init attr have been initialized
-    byte _initIndex;                                // Index to the last initiated object
+    type_ComObjectIndex _initIndex;                 // Index to the next object to be initiated
     word _lastInitTimeMillis;                       // Time (in msec) of the last init (read) request on the bus
+    type_init_read _initReads[KNXDEVICE_INIT_READS_IN_FLIGHT]; // Init read requests waiting for a response
+    byte _initReadsNb;                              // Nb of init read requests waiting for a response
+    word _initReadGapMillis;                        // Current gap (in msec) between 2 init read requests
+    word _busLoadTimeMillis;                        // Time (in msec) of the last bus load measurement
+    word _busLoadTelegramsNb;                       // Nb of bus telegrams seen by the TPUART at last measurement
+    type_InitCompletedCallbackFctPtr _initCompletedFct; // Callback notifying the completion of the init phase
     word _lastRXTimeMicros;                         // Time (in msec) of the last Tpuart Rx activity;
     word _lastTXTimeMicros;                         // Time (in msec) of the last Tpuart Tx activity;
-    KnxTelegram _txTelegram;                        // Telegram object used for telegrams sending
-    KnxTelegram *_rxTelegram;                       // Reference to the telegram received by the TPUART
+    KnxTelegram _txTelegram[2];                     // Telegram objects used for telegrams sending : one in flight, one staged
+    byte _txSlot;                                   // Index of the telegram in flight (or last sent)
+    boolean _txStaged;                              // True when the other telegram is built and ready to be sent
+    type_ComObjectIndex _txComObjectIndex[2];       // Index of the com object involved in each TX telegram
+    byte _txAttempts;                               // Nb of sendings of the telegram in flight
+    boolean _txRetryPending;                        // True when the telegram in flight failed and shall be sent again
+    word _txRetryTimeMillis;                        // Time (in msec) of the sending failure
+    word _txRetryDelayMillis;                       // Delay (in msec) before the next sending
+    byte _txMaxAttempts;                            // Max nb of sendings of a telegram
+    word _txRetryBackoffMillis;                     // Delay (in msec) before the 1st retry
+    type_TxFailureCallbackFctPtr _txFailureFct;     // Callback notifying the telegrams sending failures
+    ActionRingBuffer<type_tx_failure, KNXDEVICE_TX_FAILURES_QUEUE_SIZE> _txFailureList; // Sending failures waiting for their notification
 #if defined(KNXDEVICE_DEBUG_INFO)
-    byte _nbOfInits;                                // Nb of Initialized Com Objects
+    type_ComObjectIndex _nbOfInits;                 // Nb of Initialized Com Objects
     String *_debugStrPtr;
     static const char _debugInfoText[];
 #endif
@@ -139,37 +243,129 @@ class KnxDevice {
     // This function shall be called in the "loop()" Arduino function
     void task(void);
 
+    // KNX device execution task, scheduling variant
+    // The function executes task() and returns the delay (in usec) before task() has to be executed again
+    // (End Of Packet detection, next byte sending, ACK timeout, init read pacing, ...). 0 means "as soon as possible".
+    // The host (main loop, RTOS) may sleep during this delay instead of polling task().
+    // NB : the data arrival from the bus is not predictable, the host shall also wake up on UART reception,
+    // and after a write/update request (the returned delay does not take it into account)
+    unsigned long scheduledTask(void);
+
     // Quick method to read a short (<=1 byte) com object
     // NB : The returned value will be hazardous in case of use with long objects
-    byte read(byte objectIndex);  
+    byte read(type_ComObjectIndex objectIndex);  
 
     // Read an usual format com object
     // Supported DPT formats are short com object, U16, V16, U32, V32, F16 and F32
-    template <typename T>  e_KnxDeviceStatus read(byte objectIndex, T& returnedValue);
+    template <typename T>  e_KnxDeviceStatus read(type_ComObjectIndex objectIndex, T& returnedValue);
 
     // Read any type of com object (DPT value provided as is)
-    e_KnxDeviceStatus read(byte objectIndex, byte returnedValue[]);
+    e_KnxDeviceStatus read(type_ComObjectIndex objectIndex, byte returnedValue[]);
+
+    // Read a F16 format com object (DPT 9.xxx) as an integer value x100 (e.g. 2150 for 21.50)
+    // No floating point math is involved. Return KNX_DEVICE_ERROR if the com object format is not F16
+    e_KnxDeviceStatus readX100(type_ComObjectIndex objectIndex, long& returnedValuex100);
+
+    // Read a com object whose DPT ID is known at compile time (e.g. read<KNX_DPT_9_001>(index) returns a float)
+    // The returned type is KnxDPTIdCodec<dptId>::type (see KnxDPTCodec.h), the DPT value is decoded inline
+    // without any format lookup. NB : a default value (0) is returned if the com object length does not match the DPT
+    template <byte dptId> typename KnxDPTIdCodec<dptId>::type read(type_ComObjectIndex objectIndex);
 
     // Update com object functions :
     // For all the update functions, the com object value is updated locally
     // and a telegram is sent on the EIB bus if the object has both COMMUNICATION & TRANSMIT attributes set
 
+    // The update and update request functions return KNX_DEVICE_TX_QUEUE_FULL (253) when the TX action queue
+    // is full and the overflow policy rejected the request (see setOverflowPolicy())
+
     // Update an usual format com object
     // Supported DPT types are short com object, U16, V16, U32, V32, F16 and F32
-    template <typename T>  e_KnxDeviceStatus write(byte objectIndex, T value);
+    template <typename T>  e_KnxDeviceStatus write(type_ComObjectIndex objectIndex, T value);
 
     // Update any type of com object (rough DPT value shall be provided)
-    e_KnxDeviceStatus write(byte objectIndex, byte valuePtr[]);
+    e_KnxDeviceStatus write(type_ComObjectIndex objectIndex, byte valuePtr[]);
+
+    // Update a F16 format com object (DPT 9.xxx) with an integer value x100 (e.g. 2150 for 21.50)
+    // No floating point math is involved. Return KNX_DEVICE_ERROR if the com object format is not F16
+    // or if the value is out of the F16 range (see KNX_DPT_F16_X100_MIN/MAX)
+    e_KnxDeviceStatus writeX100(type_ComObjectIndex objectIndex, long valuex100);
+
+    // Update a com object whose DPT ID is known at compile time (e.g. write<KNX_DPT_10_001>(index, timeOfDay))
+    // The value is encoded inline without any format lookup. Return KNX_DEVICE_ERROR if the com object length
+    // does not match the DPT or if the value is not representable in the DPT format
+    template <byte dptId> e_KnxDeviceStatus write(type_ComObjectIndex objectIndex, typename KnxDPTIdCodec<dptId>::type value);
     
 
     // Com Object EIB Bus Update request
     // Request the local object to be updated with the value from the bus
     // NB : the function is asynchroneous, the update completion is notified by the knxEvents() callback
-    void update(byte objectIndex);
+    e_KnxDeviceStatus update(type_ComObjectIndex objectIndex);
+
+    // Set the behavior of the TX action queue when it is full :
+    // - ACTIONRINGBUFFER_DROP_OLDEST (default) : the oldest action is dropped, "droppedActionFct" (optional) is then
+    //   called with the index of the com object involved in the dropped action
+    // - ACTIONRINGBUFFER_REJECT_NEWEST : the new action is rejected, the function returns KNX_DEVICE_TX_QUEUE_FULL
+    // - ACTIONRINGBUFFER_BLOCK : the function executes task() till some space is freed, the new action is
+    //   rejected (KNX_DEVICE_TX_QUEUE_FULL returned) if no space is available after "blockTimeoutMillis" msec.
+    //   NB : no waiting is possible when the request is made during task() execution (i.e. within knxEvents()),
+    //   the new action is rejected immediately in that case
+    void setOverflowPolicy(e_ActionRingBufferOverflowPolicy policy, word blockTimeoutMillis = 0,
+                           type_DroppedActionCallbackFctPtr droppedActionFct = NULL);
+
+    // Set the TX retry policy (KNXDEVICE_TX_MAX_ATTEMPTS and KNXDEVICE_TX_RETRY_BACKOFF by default)
+    // A telegram not acknowledged (NACK, no answer, TPUART reset) is sent again with its repeat flag set,
+    // after "backoffMillis" msec, the delay being doubled on each new retry, up to "maxAttempts" sendings.
+    // Meanwhile, the next telegrams are held back so that the sending order is kept.
+    // When all the attempts failed, "txFailureFct" (optional) is called with the com object index and the failure cause
+    void setTxRetryPolicy(byte maxAttempts, word backoffMillis, type_TxFailureCallbackFctPtr txFailureFct = NULL);
+
+    // Enable/disable the coalescing of the write requests (disabled by default)
+    // When enabled, a new write to a com object that has a write still pending in the TX action queue
+    // replaces the pending write value, the pending write keeping its position in the queue.
+    // Only the latest value is then sent on the bus, and write bursts on one com object no longer
+    // push the actions of the other com objects out of the queue.
+    void setWriteCoalescing(boolean enable);
+
+    // Set the max nb of knxEvents() calls per task() execution (KNXDEVICE_EVENTS_BUDGET by default, 0 means no limit)
+    // The com objects updated by the bus are queued (once per object : the notification of an object already waiting
+    // for it is not repeated) and notified at the end of task(), after the bus related steps.
+    // A low budget keeps the task() duration short, the remaining events are notified by the next task() calls.
+    void setEventsBudget(byte budget);
+
+    // Set the callback notifying the updates of a com object, or of a range of com objects (from "firstIndex" to
+    // "lastIndex" included), instead of knxEvents(). A NULL callback restores the knxEvents() notification.
+    // The callbacks are stored in a dispatch table indexed by the com object index, allocated on the 1st call
+    // return KNX_DEVICE_ERROR in case of invalid index or allocation failure, else KNX_DEVICE_OK
+    e_KnxDeviceStatus setEventCallback(type_ComObjectIndex objectIndex, type_ObjectEventCallbackFctPtr eventFct);
+    e_KnxDeviceStatus setEventCallback(type_ComObjectIndex firstIndex, type_ComObjectIndex lastIndex,
+                                       type_ObjectEventCallbackFctPtr eventFct);
+
+    // Set the callback notifying, in one call, the updates of the com objects without own event callback
+    // The callback gets the indexes of the com objects notified during a task() execution (see setEventsBudget()),
+    // knxEvents() is then no longer called. A NULL callback restores the knxEvents() notification.
+    void setEventsBatchCallback(type_ObjectEventsBatchCallbackFctPtr eventsBatchFct);
+
+    // Push a byte received from the TPUART, with its reception time (usec)
+    // To be called by the UART ISR or by a reader thread when the KNXTPUART_RX_ISR_FEED option is set
+    // (see KnxTpUart::PushRxByte()), the bus reception then gets independent of the task() calling period
+    // Return false when the RX ring is full (the byte is lost)
+    boolean pushRxByte(byte data, word timeMicros);
+
+    // Get the statistics of the latency between a telegram sending and its acknowledge by the TPUART,
+    // and the resulting ACK timeout (see KNXTPUART_ACK_xxx defines in KnxTpUart.h)
+    // NB : the function shall be called after begin() only
+    const type_tpuart_ack_stats& getAckStats(void) const;
 
     // The function returns true if there is rx/tx activity ongoing, else false
     boolean isActive(void) const;
 
+    // The function returns true when the init read phase is completed, i.e. when all the com objects
+    // with Init Read attribute got their value from the bus or exhausted their read attempts
+    boolean isInitCompleted(void) const;
+
+    // Set the callback function notifying the completion of the init read phase
+    void setInitCompletedCallback(type_InitCompletedCallbackFctPtr initCompletedFct);
+
     // Inline Debug function (definition later in this file)
     // Set the string used for debug traces
 #if defined(KNXDEVICE_DEBUG_INFO)
@@ -177,6 +373,50 @@ class KnxDevice {
 #endif
 
   private:
+    // Init read phase task, called by task() till the init read phase is completed
+    void InitTask(void);
+
+    // Received telegrams task, called by task() : treat the telegrams pending in the TPUART RX slots
+    void ReceivedTelegramsTask(void);
+
+    // Add a com object in the event queue (nothing done if it is already waiting for its notification)
+    void PostEvent(type_ComObjectIndex index);
+
+    // Notify the application of the queued events (event callbacks or knxEvents() calls), up to the events budget
+    void EventsTask(void);
+
+    // Notify the application of the queued sending failures (TX failure callback calls)
+    void TxFailuresTask(void);
+
+    // Return true if both event queue elements refer to the same com object
+    static boolean IsSameEvent(const type_ComObjectIndex& index1, const type_ComObjectIndex& index2);
+
+    // Delay (in usec) before the next required task() execution
+    unsigned long TaskDelayMicros(void);
+
+    // Delay (in msec) before the next required InitTask() execution
+    word InitTaskDelayMillis(void) const;
+
+    // Build the telegram corresponding to a TX action
+    // Return false when there is no telegram to be sent
+    boolean BuildTelegram(const type_tx_action& action, KnxTelegram& telegram);
+
+    // Add an action in the TX action queue matching the com object priority
+    // "blockAllowed" shall be false for the actions added by task() itself (BLOCK policy not applied, no re-entrance)
+    // Return KNX_DEVICE_TX_QUEUE_FULL if the action has been rejected, else KNX_DEVICE_OK
+    e_KnxDeviceStatus AppendAction(const type_tx_action& action, boolean blockAllowed = true);
+
+    // Add a WRITE action in the TX action queue (coalesced with a pending one if enabled)
+    // Return KNX_DEVICE_TX_QUEUE_FULL if the action has been rejected, else KNX_DEVICE_OK
+    e_KnxDeviceStatus AppendWriteAction(const type_tx_action& action);
+
+    // Static functions called by the TX action queue in case of overflow (see setOverflowPolicy())
+    static void ActionDropped(const type_tx_action& action);
+    static boolean WaitForActionQueueSpace(void);
+
+    // Return true if both actions are WRITE actions on the same com object
+    static boolean IsSameWriteAction(const type_tx_action& action1, const type_tx_action& action2);
+
     // Static GetTpUartEvents() function called by the KnxTpUart layer (callback)
     static void GetTpUartEvents(e_KnxTpUartEvent event);
 
@@ -189,6 +429,52 @@ class KnxDevice {
 #endif
 };
 
+inline void KnxDevice::setWriteCoalescing(boolean enable) { _writeCoalescing = enable; }
+
+inline void KnxDevice::setEventsBudget(byte budget) { _eventsBudget = budget; }
+
+inline void KnxDevice::setEventsBatchCallback(type_ObjectEventsBatchCallbackFctPtr eventsBatchFct)
+{ _eventsBatchFct = eventsBatchFct; }
+
+inline e_KnxDeviceStatus KnxDevice::setEventCallback(type_ComObjectIndex objectIndex, type_ObjectEventCallbackFctPtr eventFct)
+{ return setEventCallback(objectIndex, objectIndex, eventFct); }
+
+inline boolean KnxDevice::isInitCompleted(void) const { return _initCompleted; }
+
+inline const type_tpuart_ack_stats& KnxDevice::getAckStats(void) const { return _tpuart->GetAckStats(); }
+
+inline boolean KnxDevice::pushRxByte(byte data, word timeMicros)
+{ return (_tpuart != NULL) && _tpuart->PushRxByte(data, timeMicros); }
+
+inline void KnxDevice::setInitCompletedCallback(type_InitCompletedCallbackFctPtr initCompletedFct)
+{ _initCompletedFct = initCompletedFct; }
+
+template <byte dptId> typename KnxDPTIdCodec<dptId>::type KnxDevice::read(type_ComObjectIndex objectIndex)
+{
+  typename KnxDPTIdCodec<dptId>::type value = typename KnxDPTIdCodec<dptId>::type();
+  if (_comObjectsList[objectIndex].GetLength() != KnxDPTLength<dptId>::value) return value;
+  if (KnxDPTLength<dptId>::value <= 2)
+  { // short com object case
+    byte shortValue = _comObjectsList[objectIndex].GetValue();
+    KnxDPTIdCodec<dptId>::Decode(&shortValue, value);
+  }
+  else KnxDPTIdCodec<dptId>::Decode(_comObjectsList[objectIndex].GetValuePtr(), value); // decoded in place (no copy)
+  return value;
+}
+
+template <byte dptId> e_KnxDeviceStatus KnxDevice::write(type_ComObjectIndex objectIndex, typename KnxDPTIdCodec<dptId>::type value)
+{
+  type_tx_action action;
+  if (_comObjectsList[objectIndex].GetLength() != KnxDPTLength<dptId>::value) return KNX_DEVICE_ERROR;
+  // the DPT value is directly written in the action (no dynamic allocation)
+  if (!KnxDPTIdCodec<dptId>::Encode(value, (KnxDPTLength<dptId>::value <= 2) ? &action.byteValue : action.longValue))
+    return KNX_DEVICE_ERROR;
+  action.command = EIB_WRITE_REQUEST;
+  action.index = objectIndex;
+  return AppendWriteAction(action);
+}
+
+
 #if defined(KNXDEVICE_DEBUG_INFO)
 // Set the string used for debug traces
 inline void KnxDevice::SetDebugString(String *strPtr) {_debugStrPtr = strPtr;}
@@ -34,19 +34,50 @@ void KnxTelegram::ClearTelegram(void)
 // multicast, routing counter = 6, payload length = 1
   for (byte i =0; i < KNX_TELEGRAM_MAX_SIZE; i++) _telegram[i] = 0; 
   _controlField = CONTROL_FIELD_DEFAULT_VALUE ; _routing= ROUTING_FIELD_DEFAULT_VALUE;
+  _xorSum = CONTROL_FIELD_DEFAULT_VALUE ^ ROUTING_FIELD_DEFAULT_VALUE; // all the other databytes are 0
+}
+
+
+// Update the XOR sum following the change of the routing field
+// The bytes between the previous and the new checksum indexes join (or leave) the databytes
+void KnxTelegram::UpdateXorSumRouting(byte oldRouting)
+{
+  byte oldIndex = KNX_TELEGRAM_HEADER_SIZE + (oldRouting & ROUTING_FIELD_PAYLOAD_LENGTH_MASK) + 1;
+  byte newIndex = GetChecksumIndex();
+  _xorSum ^= oldRouting ^ _routing;
+  for (byte i = oldIndex; i < newIndex; i++) _xorSum ^= _telegram[i];
+  for (byte i = newIndex; i < oldIndex; i++) _xorSum ^= _telegram[i];
+}
+
+
+void KnxTelegram::InitXorSum(void)
+{
+  byte indexChecksum = GetChecksumIndex();
+  _xorSum = 0;
+  for (byte i = 0; i < indexChecksum ; i++) _xorSum ^= _telegram[i]; // XOR Sum of all the databytes
 }
 
    
 void KnxTelegram::SetLongPayload(const byte origin[], byte nbOfBytes) 
 {
   if (nbOfBytes > KNX_TELEGRAM_PAYLOAD_MAX_SIZE-2) nbOfBytes = KNX_TELEGRAM_PAYLOAD_MAX_SIZE-2;
-  for(byte i=0; i < nbOfBytes; i++) _payloadChecksum[i] = origin[i];
+  for(byte i=0; i < nbOfBytes; i++)
+  {
+    byte old = _payloadChecksum[i];
+    _payloadChecksum[i] = origin[i];
+    UpdateXorSum(KNX_TELEGRAM_HEADER_SIZE + 2 + i, old);
+  }
 }
 
 
 void KnxTelegram::ClearLongPayload(void)
 {
-  for(byte i=0; i < KNX_TELEGRAM_PAYLOAD_MAX_SIZE-1; i++) _payloadChecksum[i] = 0;
+  for(byte i=0; i < KNX_TELEGRAM_PAYLOAD_MAX_SIZE-1; i++)
+  {
+    byte old = _payloadChecksum[i];
+    _payloadChecksum[i] = 0;
+    UpdateXorSum(KNX_TELEGRAM_HEADER_SIZE + 2 + i, old);
+  }
 }
 
 
@@ -57,34 +88,18 @@ void KnxTelegram::GetLongPayload(byte destination[], byte nbOfBytes) const
 };
     
 
-byte KnxTelegram::CalculateChecksum(void) const
-{
-  byte indexChecksum, xorSum=0;  
-  indexChecksum = KNX_TELEGRAM_HEADER_SIZE + GetPayloadLength() + 1;
-  for (byte i = 0; i < indexChecksum ; i++)   xorSum ^= _telegram[i]; // XOR Sum of all the databytes
-  return (byte)(~xorSum); // Checksum equals 1's complement of databytes XOR sum
-}
-
-
-void KnxTelegram::UpdateChecksum(void)
-{
-  byte indexChecksum, xorSum=0; 
-  indexChecksum = KNX_TELEGRAM_HEADER_SIZE + GetPayloadLength() + 1;
-  for (byte i = 0; i < indexChecksum ; i++)   xorSum ^= _telegram[i]; // XOR Sum of all the databytes
-  _telegram[indexChecksum] = ~xorSum; // Checksum equals 1's complement of databytes XOR sum
-}
-
-
 void KnxTelegram::Copy(KnxTelegram& dest) const
 {
   byte length = GetTelegramLength();
   for (byte i=0; i<length ; i++)  dest._telegram[i] = _telegram[i];
+  dest._xorSum = _xorSum; // the databytes are the same
 }
 
 
 void KnxTelegram::CopyHeader(KnxTelegram& dest) const
 {
   for(byte i=0; i < KNX_TELEGRAM_HEADER_SIZE; i++) dest._telegram[i] = _telegram[i];
+  dest.InitXorSum(); // the payload length, and then the databytes, may have changed
 }
 
 
@@ -131,6 +131,18 @@ class KnxTelegram {
         byte _payloadChecksum[KNX_TELEGRAM_PAYLOAD_MAX_SIZE-1]; // byte 8 to 22
       };
     };
+    // XOR sum of the databytes (i.e. all the bytes preceding the checksum byte)
+    // It is kept up to date by every function changing the telegram content, the checksum is then got in O(1)
+    byte _xorSum;
+
+    // Index of the checksum byte (depends on the payload length)
+    byte GetChecksumIndex(void) const;
+    // Update the XOR sum following the change of a byte (previous value is "oldData")
+    void UpdateXorSum(byte byteIndex, byte oldData);
+    // Update the XOR sum following the change of the routing field (the checksum index may have moved)
+    void UpdateXorSumRouting(byte oldRouting);
+    // Calculation of the XOR sum from scratch
+    void InitXorSum(void);
 
   public:
   // CONSTRUCTOR
@@ -179,6 +191,10 @@ class KnxTelegram {
 
     byte GetChecksum(void) const;
     boolean IsChecksumCorrect(void) const;
+    // NB : the checksum is maintained incrementally by the setters, CalculateChecksum() and UpdateChecksum() are O(1)
+    byte CalculateChecksum(void) const;
+    // Let the class calculate and update the proper checksum value in the telegram
+    void UpdateChecksum(void);
 
   // functions NOT INLINED (see definitions in KnxTelegram.cpp)
     void ClearTelegram(void); // (re)set telegram with default values
@@ -193,9 +209,6 @@ class KnxTelegram {
     // Clear the whole payload except the 1st payload byte
     void ClearLongPayload(void);
 
-    byte CalculateChecksum(void) const;
-    // Let the class calculate and update the proper checksum value in the telegram
-    void UpdateChecksum(void);
 
     // Whole telegram copy
     void Copy(KnxTelegram& dest) const;
@@ -212,14 +225,21 @@ class KnxTelegram {
 
 
 // --------------- Definition of the INLINED functions : -----------------
+inline byte KnxTelegram::GetChecksumIndex(void) const
+{ return (KNX_TELEGRAM_HEADER_SIZE + GetPayloadLength() + 1); }
+
+inline void KnxTelegram::UpdateXorSum(byte byteIndex, byte oldData)
+{ if (byteIndex < GetChecksumIndex()) _xorSum ^= oldData ^ _telegram[byteIndex]; }
+
 inline void KnxTelegram::ChangePriority(e_KnxPriority priority)
-{ _controlField &= ~CONTROL_FIELD_PRIORITY_MASK; _controlField |= priority & CONTROL_FIELD_PRIORITY_MASK;}
+{ byte old = _controlField;
+  _controlField &= ~CONTROL_FIELD_PRIORITY_MASK; _controlField |= priority & CONTROL_FIELD_PRIORITY_MASK; _xorSum ^= old ^ _controlField;}
     
 inline e_KnxPriority KnxTelegram::GetPriority(void) const 
 {return (e_KnxPriority)(_controlField & CONTROL_FIELD_PRIORITY_MASK);}
 
 inline void KnxTelegram::SetRepeated(void ) 
-{ CONTROL_FIELD_SET_REPEATED(_controlField);};
+{ byte old = _controlField; CONTROL_FIELD_SET_REPEATED(_controlField); _xorSum ^= old ^ _controlField;};
     
 inline boolean KnxTelegram::IsRepeated(void) const 
 {if (_controlField & CONTROL_FIELD_REPEATED_MASK ) return false; else return true ; }
@@ -227,6 +247,7 @@ inline boolean KnxTelegram::IsRepeated(void) const
 inline void KnxTelegram::SetSourceAddress(word addr) { 
   // WARNING : works with little endianness only
   // The adresses within KNX telegram are big endian
+  _xorSum ^= _sourceAddrL ^ _sourceAddrH ^ (byte) addr ^ byte(addr>>8);
   _sourceAddrL = (byte) addr; _sourceAddrH = byte(addr>>8);}
 
 inline word KnxTelegram::GetSourceAddress(void) const {
@@ -237,6 +258,7 @@ inline word KnxTelegram::GetSourceAddress(void) const {
 inline void KnxTelegram:: SetTargetAddress(word addr) { 
   // WARNING : works with little endianness only
   // The adresses within KNX telegram are big endian
+  _xorSum ^= _targetAddrL ^ _targetAddrH ^ (byte) addr ^ byte(addr>>8);
   _targetAddrL = (byte) addr; _targetAddrH = byte(addr>>8);}
 
 inline word KnxTelegram::GetTargetAddress(void) const {
@@ -248,17 +270,21 @@ inline boolean KnxTelegram::IsMulticast(void) const
 {return (_routing & ROUTING_FIELD_TARGET_ADDRESS_TYPE_MASK);}
 
 inline void KnxTelegram::SetMulticast(boolean mode)
-{ if (mode) _routing|= ROUTING_FIELD_TARGET_ADDRESS_TYPE_MASK;
-  else _routing &= ~ROUTING_FIELD_TARGET_ADDRESS_TYPE_MASK; }
+{ byte old = _routing;
+  if (mode) _routing|= ROUTING_FIELD_TARGET_ADDRESS_TYPE_MASK;
+  else _routing &= ~ROUTING_FIELD_TARGET_ADDRESS_TYPE_MASK;
+  _xorSum ^= old ^ _routing; }
  
 inline void KnxTelegram::ChangeRoutingCounter(byte counter) 
-{ counter <<= 4; _routing &= ~ROUTING_FIELD_COUNTER_MASK; _routing |= (counter & ROUTING_FIELD_COUNTER_MASK); }
+{ byte old = _routing;
+  counter <<= 4; _routing &= ~ROUTING_FIELD_COUNTER_MASK; _routing |= (counter & ROUTING_FIELD_COUNTER_MASK); _xorSum ^= old ^ _routing; }
 
 inline byte KnxTelegram::GetRoutingCounter(void) const 
 { return ((_routing & ROUTING_FIELD_COUNTER_MASK)>>4); }
 
 inline void KnxTelegram::SetPayloadLength(byte length) 
-{ _routing&= ~ROUTING_FIELD_PAYLOAD_LENGTH_MASK ; _routing |= length & ROUTING_FIELD_PAYLOAD_LENGTH_MASK; }
+{ byte old = _routing;
+  _routing&= ~ROUTING_FIELD_PAYLOAD_LENGTH_MASK ; _routing |= length & ROUTING_FIELD_PAYLOAD_LENGTH_MASK; UpdateXorSumRouting(old); }
 
 inline byte KnxTelegram::GetPayloadLength(void) const 
 {return (_routing & ROUTING_FIELD_PAYLOAD_LENGTH_MASK);}
@@ -267,17 +293,19 @@ inline byte KnxTelegram::GetTelegramLength(void) const
 { return (KNX_TELEGRAM_LENGTH_OFFSET + GetPayloadLength());}
 
 inline void KnxTelegram::SetCommand(e_KnxCommand cmd) {
+  byte oldH = _commandH, oldL = _commandL;
   _commandH &= ~COMMAND_FIELD_HIGH_COMMAND_MASK; _commandH |= (cmd >> 2);
-  _commandL &= ~COMMAND_FIELD_LOW_COMMAND_MASK;  _commandL |= (cmd << 6);}
+  _commandL &= ~COMMAND_FIELD_LOW_COMMAND_MASK;  _commandL |= (cmd << 6);
+  UpdateXorSum(6, oldH); UpdateXorSum(7, oldL);}
 
 inline e_KnxCommand KnxTelegram::GetCommand(void) const 
 {return (e_KnxCommand)(((_commandL & COMMAND_FIELD_LOW_COMMAND_MASK)>>6) + ((_commandH & COMMAND_FIELD_HIGH_COMMAND_MASK)<<2)); };
     
 inline void KnxTelegram::SetFirstPayloadByte(byte data) 
-{ _commandL &= ~COMMAND_FIELD_LOW_DATA_MASK ; _commandL |= data & COMMAND_FIELD_LOW_DATA_MASK; }
+{ byte old = _commandL; _commandL &= ~COMMAND_FIELD_LOW_DATA_MASK ; _commandL |= data & COMMAND_FIELD_LOW_DATA_MASK; UpdateXorSum(7, old); }
 
 inline void KnxTelegram::ClearFirstPayloadByte(void)
-{ _commandL &= ~COMMAND_FIELD_LOW_DATA_MASK;}
+{ byte old = _commandL; _commandL &= ~COMMAND_FIELD_LOW_DATA_MASK; UpdateXorSum(7, old); }
 
 inline byte KnxTelegram::GetFirstPayloadByte(void) const 
 { return (_commandL & COMMAND_FIELD_LOW_DATA_MASK);}
@@ -286,7 +314,8 @@ inline byte KnxTelegram::ReadRawByte(byte byteIndex) const
 { return _telegram[byteIndex];}
 
 inline void KnxTelegram::WriteRawByte(byte data, byte byteIndex)
-{ _telegram[byteIndex] = data;}
+{ byte old = _telegram[byteIndex]; _telegram[byteIndex] = data;
+  if (byteIndex == 5) UpdateXorSumRouting(old); else UpdateXorSum(byteIndex, old); }
 
 inline byte KnxTelegram::GetChecksum(void) const 
 { return (_payloadChecksum[GetPayloadLength() - 1]);}
@@ -294,4 +323,10 @@ inline byte KnxTelegram::GetChecksum(void) const
 inline boolean KnxTelegram::IsChecksumCorrect(void) const 
 { return (GetChecksum()==CalculateChecksum());}
 
+inline byte KnxTelegram::CalculateChecksum(void) const
+{ return (byte)(~_xorSum); } // Checksum equals 1's complement of databytes XOR sum
+
+inline void KnxTelegram::UpdateChecksum(void)
+{ _telegram[GetChecksumIndex()] = ~_xorSum; } // the checksum byte is not part of the databytes XOR sum
+
 #endif // KNXTELEGRAM_H
@@ -40,18 +40,47 @@ KnxTpUart::KnxTpUart(HardwareSerial& serial, word physicalAddr, type_KnxTpUartMo
 : _serial(serial), _physicalAddr(physicalAddr), _mode(mode)
 {
   _rx.state = RX_RESET;
-  _rx.addressedComObjectIndex = 0;
+  _rx.lastByteRxTimeMicros = 0;
+  _rx.readBytesNb = 0;
   _tx.state = TX_RESET;
   _tx.sentTelegram = NULL;
   _tx.ackFctPtr = NULL;
   _tx.nbRemainingBytes = 0;
   _tx.txByteIndex = 0;
+  _tx.sentMessageTimeMillis = 0;
+  _tx.uartEmptyTimeMicros = 0;
   _stateIndication = 0;
   _evtCallbackFct = NULL;
   _comObjectsList = NULL;
-  _assignedComObjectsNb = 0;
-  _orderedIndexTable = NULL;
+  _assignedAddrsNb = 0;
+  _maxFanOutNb = 0;
+  _orderedAddrTable = NULL;
+#if defined(KNXTPUART_ADDR_LOOKUP_BITMAP)
+  _addrBitmap = NULL;
+#elif defined(KNXTPUART_ADDR_LOOKUP_HASH)
+  _addrHashTable = NULL;
+  _addrHashBits = 0;
+#endif
   _stateIndication = 0;
+  _busTelegramsNb = 0;
+  for (byte i = 0; i < KNXTPUART_RX_SLOTS_NB; i++)
+  {
+    _rxSlots[i].addressedTableIndex = 0;
+    _rxSlots[i].addressedComObjectsNb = 0;
+  }
+  _rxSlotsHead = 0;
+  _rxSlotsNb = 0;
+  _rxRingHead = 0;
+  _rxRingTail = 0;
+  for (byte i = 0; i < KNXTPUART_ACK_LATENCY_BINS_NB; i++) _ackLatencyBins[i] = 0;
+  _ackLatencySamplesNb = 0;
+  _ackStats.samplesNb = 0;
+  _ackStats.timeoutsNb = 0;
+  _ackStats.lastLatencyMillis = 0;
+  _ackStats.minLatencyMillis = 0xFFFF;
+  _ackStats.maxLatencyMillis = 0;
+  _ackStats.p99LatencyMillis = 0;
+  _ackStats.ackTimeoutMillis = KNXTPUART_ACK_TIMEOUT_CEILING;
 #if defined(KNXTPUART_DEBUG_INFO) || defined(KNXTPUART_DEBUG_ERROR)
   _debugStrPtr = NULL;
 #endif
@@ -61,7 +90,8 @@ KnxTpUart::KnxTpUart(HardwareSerial& serial, word physicalAddr, type_KnxTpUartMo
 // Destructor
 KnxTpUart::~KnxTpUart()
 {
-  if (_orderedIndexTable) free(_orderedIndexTable);
+  if (_orderedAddrTable) free(_orderedAddrTable);
+  FreeAddressLookup();
   // close the serial communication if opened
   if ( (_rx.state > RX_RESET) || (_tx.state > TX_RESET) ) 
   {
@@ -82,6 +112,7 @@ byte KnxTpUart::Reset(void)
 {
 word startTime, nowTime;
 byte attempts = 10;
+type_tpuart_rx_byte rxByte;
 
   if ( (_rx.state > RX_RESET) || (_tx.state > TX_RESET) ) 
   { // HOT RESET case
@@ -93,6 +124,7 @@ byte attempts = 10;
   _serial.begin(19200,SERIAL_8E1);
   //_serial.begin(19200);
   //UCSR1C = UCSR1C | B00100000; // Even Parity
+  _rxRingHead = _rxRingTail; // flush the RX ring
   
   while(attempts--)
   { // we send a RESET REQUEST and wait for the reset indication answer
@@ -101,9 +133,12 @@ byte attempts = 10;
 
     for (nowTime = startTime = (word) millis() ; TimeDeltaWord(nowTime,startTime) < 1000 /* 1 sec */ ; nowTime = (word)millis())
     {
-      if (_serial.available() > 0) 
+#ifndef KNXTPUART_RX_ISR_FEED
+      ReadSerialBytes();
+#endif
+      if (PopRxByte(rxByte))
       {
-        if (_serial.read() == TPUART_RESET_INDICATION)
+        if (rxByte.data == TPUART_RESET_INDICATION)
         {
           _rx.state = RX_INIT; _tx.state = TX_INIT;
 #if defined(KNXTPUART_DEBUG_INFO)
@@ -122,24 +157,57 @@ byte attempts = 10;
 }
 
 
+// Ordering of the @ table : by increasing address, and by increasing index for identical addresses
+static boolean IsBefore(const type_tpuart_addr_entry& entry1, const type_tpuart_addr_entry& entry2)
+{
+  return ((entry1.addr < entry2.addr) || ((entry1.addr == entry2.addr) && (entry1.index < entry2.index)));
+}
+
+
+// Move down the element at position "root" in the heap made of the "size" first elements of "table"
+// NB : the children positions are computed on unsigned long to avoid any overflow with word positions
+static void SiftDown(type_tpuart_addr_entry table[], unsigned long root, unsigned long size)
+{
+unsigned long child;
+type_tpuart_addr_entry swap;
+
+  while ((child = 2 * root + 1) < size)
+  {
+    if ((child + 1 < size) && IsBefore(table[child], table[child + 1])) child++; // biggest child
+    if (!IsBefore(table[root], table[child])) return; // heap property is satisfied
+    swap = table[root]; table[root] = table[child]; table[child] = swap;
+    root = child;
+  }
+}
+
+
 // Attach a list of com objects
 // NB1 : only the objects with "communication" attribute are considered by the TPUART
-// NB2 : In case of objects with identical address, the object with highest index only is considered
+// NB2 : Several objects may share the same address, a telegram with that address targets all of them
+// NB3 : The objects listen to their address and to their additional listening addresses
 // return KNX_TPUART_ERROR_NOT_INIT_STATE (254) if the TPUART is not in Init state
 // The function must be called prior to Init() execution
-byte KnxTpUart::AttachComObjectsList(KnxComObject comObjectsList[], byte listSize)
+// The @ table (one entry per listening address of each object) is heap sorted (O(n log n) time, no extra memory) :
+// the objects sharing an address are then contiguous, ranked by increasing index, and make the address fan-out list
+byte KnxTpUart::AttachComObjectsList(KnxComObject comObjectsList[], type_ComObjectIndex listSize)
 {
 #define IS_COM(index) (comObjectsList[index].GetIndicator() & KNX_COM_OBJ_C_INDICATOR)
-#define ADDR(index) (comObjectsList[index].GetAddr())
+type_ComObjectIndex i;
+unsigned long addrsNb;
+word j, k;
+byte rank;
+type_tpuart_addr_entry swap;
 
   if ((_rx.state!=RX_INIT) || (_tx.state!=TX_INIT)) return KNX_TPUART_ERROR_NOT_INIT_STATE;
 
-  if (_orderedIndexTable)
+  if (_orderedAddrTable)
   {  // a list is already attached, we detach it
-    free(_orderedIndexTable);
-    _orderedIndexTable = NULL;
+    free(_orderedAddrTable);
+    _orderedAddrTable = NULL;
+    FreeAddressLookup();
     _comObjectsList = NULL;
-    _assignedComObjectsNb = 0;
+    _assignedAddrsNb = 0;
+    _maxFanOutNb = 0;
   }
   if ((!comObjectsList) || (!listSize))
   {
@@ -148,51 +216,80 @@ byte KnxTpUart::AttachComObjectsList(KnxComObject comObjectsList[], byte listSiz
 #endif
     return  KNX_TPUART_OK;
   }
-  // Count all the com objects with communication indicator
-  for (byte i=0; i < listSize ; i++) if (IS_COM(i)) _assignedComObjectsNb++;
-  if (!_assignedComObjectsNb)
+  // Count all the listening addresses of the com objects with communication indicator
+  addrsNb = 0;
+  for (i=0; i < listSize ; i++) if (IS_COM(i)) addrsNb += 1 + comObjectsList[i].GetListeningAddrsNb();
+  if (!addrsNb)
   {
 #if defined(KNXTPUART_DEBUG_INFO)
     DebugInfo("AttachComObjectsList : warning : no object with com attribute in the list!\n");
 #endif
     return  KNX_TPUART_OK;    
   }
-  // Deduct the duplicate addresses
-  for (byte i=0; i < listSize ; i++)
+  // Creation of the @ table, filled with the (@, index) pairs
+  if (addrsNb <= 0xFFFF) _orderedAddrTable = (type_tpuart_addr_entry*) malloc(addrsNb * sizeof(type_tpuart_addr_entry));
+  if (!_orderedAddrTable)
+  {
+#if defined(KNXTPUART_DEBUG_ERROR)
+    DebugError("AttachComObjectsList : error : not enough memory!\n");
+#endif
+    return KNX_TPUART_ERROR;
+  }
+  j = 0;
+  for (i=0; i < listSize ; i++)
   {
     if (!IS_COM(i)) continue;
-    for (byte j=0; j < listSize ; j++)
+    _orderedAddrTable[j].addr = comObjectsList[i].GetAddr(); _orderedAddrTable[j++].index = i;
+    for (rank = 0; rank < comObjectsList[i].GetListeningAddrsNb(); rank++)
     {
-      if ( (i!=j) && (ADDR(j) == ADDR(i)) && (IS_COM(j)) )
-      { // duplicate address found
-        if (j<i) break; // duplicate address already treated
-        else 
-        {
-          _assignedComObjectsNb--;
-#if defined(KNXTPUART_DEBUG_INFO)
-          DebugInfo("AttachComObjectsList : warning : duplicate address found!\n");
-#endif
-        }
-      }
+      _orderedAddrTable[j].addr = comObjectsList[i].GetListeningAddr(rank); _orderedAddrTable[j++].index = i;
     }
   }
   _comObjectsList = comObjectsList;
-  // Creation of the ordered index table
-  _orderedIndexTable = (byte*) malloc(_assignedComObjectsNb);
-  word minMin = 0x0000;   // minimum min value searched  
-  word foundMin = 0xFFFF; // min value found so far
-  for (byte i=0; i < _assignedComObjectsNb; i++)
+
+  // Heap sort of the table by increasing address (and increasing index for identical addresses)
+  // The sort is skipped when the objects are already declared by increasing address
+  for (j = 1; (j < addrsNb) && !IsBefore(_orderedAddrTable[j], _orderedAddrTable[j - 1]); j++);
+  if (j < addrsNb)
   {
-    for (byte j=0; j < listSize ; j++) 
+    for (j = addrsNb / 2; j > 0; j--) SiftDown(_orderedAddrTable, j - 1, addrsNb);
+    for (j = addrsNb - 1; j > 0; j--)
     {
-      if ( (IS_COM(j)) && (ADDR(j)>=minMin) && (ADDR(j)<=foundMin) )
-      {
-        foundMin = ADDR(j);
-        _orderedIndexTable[i] = j;
-      }
+      swap = _orderedAddrTable[0]; _orderedAddrTable[0] = _orderedAddrTable[j]; _orderedAddrTable[j] = swap;
+      SiftDown(_orderedAddrTable, 0, j);
     }
-    minMin = foundMin + 1;
-    foundMin = 0xFFFF;
+  }
+
+  // Removal of the duplicate pairs (an object listing the same address twice)
+  for (j = 0, k = 0; j < addrsNb; j++)
+  {
+    if (k && (_orderedAddrTable[k - 1].addr == _orderedAddrTable[j].addr)
+          && (_orderedAddrTable[k - 1].index == _orderedAddrTable[j].index)) continue;
+    _orderedAddrTable[k++] = _orderedAddrTable[j];
+  }
+  _assignedAddrsNb = k;
+
+  // Length of each fan-out list (run of pairs sharing an address), stored in the 1st pair of the run,
+  // and length of the largest one
+  for (j = 0; j < _assignedAddrsNb; j = k)
+  {
+    for (k = j + 1; (k < _assignedAddrsNb) && (_orderedAddrTable[k].addr == _orderedAddrTable[j].addr); k++)
+      _orderedAddrTable[k].fanOutNb = 0;
+    _orderedAddrTable[j].fanOutNb = k - j;
+    if (_orderedAddrTable[j].fanOutNb > _maxFanOutNb) _maxFanOutNb = _orderedAddrTable[j].fanOutNb;
+  }
+
+  if (!BuildAddressLookup())
+  {
+#if defined(KNXTPUART_DEBUG_ERROR)
+    DebugError("AttachComObjectsList : error : not enough memory for the address lookup!\n");
+#endif
+    free(_orderedAddrTable);
+    _orderedAddrTable = NULL;
+    _comObjectsList = NULL;
+    _assignedAddrsNb = 0;
+    _maxFanOutNb = 0;
+    return KNX_TPUART_ERROR;
   }
 #if defined(KNXTPUART_DEBUG_INFO)
   DebugInfo("AttachComObjectsList successful\n");
@@ -269,170 +366,213 @@ byte KnxTpUart::SendTelegram(KnxTelegram& sentTelegram)
 // This function shall be called periodically in order to allow a correct reception of the EIB bus data
 // Assuming the TPUART speed is configured to 19200 baud, a character (8 data + 1 start + 1 parity + 1 stop)
 // is transmitted in 0,58ms.
-// In order not to miss any End Of Packets (i.e. a gap from 2 to 2,5ms), the function shall be called at a max period of 0,5ms.
-// Typical calling period is 400 usec.
+// All the pending received bytes are treated, the End Of Packets (i.e. a gap from 2 to 2,5ms) are detected
+// using the bytes reception times, so that a late call does not corrupt the EOP detection.
+// Without KNXTPUART_RX_ISR_FEED option, the bytes are time stamped when read by the function, it shall then
+// be called at a max period of 0,5ms. Typical calling period is 400 usec.
 void KnxTpUart::RXTask(void)
 {
-byte incomingByte;
+type_tpuart_rx_byte rxByte;
 word nowTime;
-static byte readBytesNb; // Nb of read bytes during an EIB telegram reception
-static KnxTelegram telegram; // telegram being received
-static byte addressedComObjectIndex; // index of the com object targeted by the received telegram
-static word lastByteRxTimeMicrosec;
 
-// === STEP 1 : Check EOP in case a Telegram is being received ===
-  if (_rx.state >= RX_EIB_TELEGRAM_RECEPTION_STARTED)
-  { // a telegram reception is ongoing
+#ifndef KNXTPUART_RX_ISR_FEED
+  ReadSerialBytes();
+#endif
+
+  while (true)
+  {
+    // NB : the current time is got prior to checking the ring, so that a byte received in between
+    // can not be taken for an EOP
     nowTime = (word) micros(); // word cast because a 65ms looping counter is long enough
-    if(TimeDeltaWord(nowTime,lastByteRxTimeMicrosec) > 2000 /* 2 ms */ )
-    { // EOP detected, the telegram reception is completed
+    if (!PopRxByte(rxByte)) break;
+
+    // === STEP 1 : Check EOP prior to the new byte in case a Telegram is being received ===
+    if ( (_rx.state >= RX_EIB_TELEGRAM_RECEPTION_STARTED)
+        && (TimeDeltaWord(rxByte.timeMicros, _rx.lastByteRxTimeMicros) > 2000 /* 2 ms */ ) )
+      EndOfPacket();
+
+    // === STEP 2 : Treat the new byte ===
+    _rx.lastByteRxTimeMicros = rxByte.timeMicros;
+    // NB : after a TPUART reset indication, the RX ring is flushed by the Reset() executed on the reset event,
+    // or else the remaining bytes are ignored in RX_STOPPED state
+    ReceiveByte(rxByte.data);
+  }
 
-      switch (_rx.state)
-      {
-        case RX_EIB_TELEGRAM_RECEPTION_STARTED : // we are not supposed to get EOP now, the telegram is incomplete
-        case RX_EIB_TELEGRAM_RECEPTION_LENGTH_INVALID :
-          _evtCallbackFct(TPUART_EVENT_EIB_TELEGRAM_RECEPTION_ERROR); // Notify telegram reception error
-          break;
-
-        case RX_EIB_TELEGRAM_RECEPTION_ADDRESSED :
-          if (telegram.IsChecksumCorrect())
-          { // checksum correct, let's update the _rx struct with the received telegram and correct index
-        	telegram.Copy(_rx.receivedTelegram);
-            _rx.addressedComObjectIndex  = addressedComObjectIndex;
-            _evtCallbackFct(TPUART_EVENT_RECEIVED_EIB_TELEGRAM); // Notify the new received telegram
-          }
-          else
-          {  // checksum incorrect, notify error
-            _evtCallbackFct(TPUART_EVENT_EIB_TELEGRAM_RECEPTION_ERROR); // Notify telegram reception error
-          }
-          break;
+  // === STEP 3 : No more data, check EOP in case a Telegram is being received ===
+  if ( (_rx.state >= RX_EIB_TELEGRAM_RECEPTION_STARTED)
+      && (TimeDeltaWord(nowTime, _rx.lastByteRxTimeMicros) > 2000 /* 2 ms */ ) )
+    EndOfPacket();
+}
 
-        // case RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED : break; // nothing to do!
-      
-        default : break; 
-      } // end of switch
 
-      // we move state back to RX IDLE in any case
-      _rx.state = RX_IDLE_WAITING_FOR_CTRL_FIELD;
-    } // end EOP detected
-  }
-  
-// === STEP 2 : Get New RX Data ===
-  if (_serial.available() > 0) 
+// Move the bytes received by the serial port to the RX ring (stamped with the current time)
+// The bytes remain in the serial port buffer when the ring is full
+void KnxTpUart::ReadSerialBytes(void)
+{
+  while ( (RxRingElementsNb() < KNXTPUART_RX_RING_SIZE) && (_serial.available() > 0) )
+    PushRxByte((byte)(_serial.read()), (word)micros());
+}
+
+
+// Treat an End Of Packet (the telegram reception is completed)
+void KnxTpUart::EndOfPacket(void)
+{
+  _busTelegramsNb++;
+
+  switch (_rx.state)
   {
-    incomingByte = (byte)(_serial.read());
-    lastByteRxTimeMicrosec = (word)micros();
-	
-    switch (_rx.state)
-    {
-      case RX_IDLE_WAITING_FOR_CTRL_FIELD:
-          // CASE OF EIB MESSAGE
-          if ((incomingByte & EIB_CONTROL_FIELD_PATTERN_MASK) == EIB_CONTROL_FIELD_VALID_PATTERN)
+    case RX_EIB_TELEGRAM_RECEPTION_STARTED : // we are not supposed to get EOP now, the telegram is incomplete
+    case RX_EIB_TELEGRAM_RECEPTION_LENGTH_INVALID :
+      _evtCallbackFct(TPUART_EVENT_EIB_TELEGRAM_RECEPTION_ERROR); // Notify telegram reception error
+      break;
+
+    case RX_EIB_TELEGRAM_RECEPTION_ADDRESSED :
+      if (RxAssemblySlot().telegram.IsChecksumCorrect())
+      { // checksum correct, the assembly slot is handed over to the application (no copy)
+        type_tpuart_rx_slot& slot = RxAssemblySlot();
+        // the targeted com objects are searched now, out of the RX ACK time window
+        FindComObjects(slot.telegram.GetTargetAddress(), slot.addressedTableIndex, slot.addressedComObjectsNb);
+        _rxSlotsNb++; // the next free slot becomes the assembly slot
+        _evtCallbackFct(TPUART_EVENT_RECEIVED_EIB_TELEGRAM); // Notify the new received telegram
+      }
+      else
+      {  // checksum incorrect, notify error
+        _evtCallbackFct(TPUART_EVENT_EIB_TELEGRAM_RECEPTION_ERROR); // Notify telegram reception error
+      }
+      break;
+
+    // case RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED : break; // nothing to do!
+
+    default : break;
+  } // end of switch
+
+  // we move state back to RX IDLE in any case
+  _rx.state = RX_IDLE_WAITING_FOR_CTRL_FIELD;
+}
+
+
+// Treat a received byte (RX state machine)
+void KnxTpUart::ReceiveByte(byte incomingByte)
+{
+  switch (_rx.state)
+  {
+    case RX_IDLE_WAITING_FOR_CTRL_FIELD:
+        // CASE OF EIB MESSAGE
+        if ((incomingByte & EIB_CONTROL_FIELD_PATTERN_MASK) == EIB_CONTROL_FIELD_VALID_PATTERN)
+        {
+          _rx.state = RX_EIB_TELEGRAM_RECEPTION_STARTED; 
+          _rx.readBytesNb = 1; RxAssemblySlot().telegram.WriteRawByte(incomingByte,0);
+        }
+        // CASE OF TPUART_DATA_CONFIRM_SUCCESS NOTIFICATION
+        else if (incomingByte == TPUART_DATA_CONFIRM_SUCCESS) 
+        {
+          if (_tx.state == TX_WAITING_ACK)
           {
-            _rx.state = RX_EIB_TELEGRAM_RECEPTION_STARTED; 
-            readBytesNb = 1; telegram.WriteRawByte(incomingByte,0);
+            RecordAckLatency(TimeDeltaWord((word)millis(), _tx.sentMessageTimeMillis));
+            _tx.ackFctPtr(ACK_RESPONSE);
+            _tx.state = TX_IDLE;
           }
-          // CASE OF TPUART_DATA_CONFIRM_SUCCESS NOTIFICATION
-          else if (incomingByte == TPUART_DATA_CONFIRM_SUCCESS) 
-          {
-            if (_tx.state == TX_WAITING_ACK)
-            {
-              _tx.ackFctPtr(ACK_RESPONSE);
-              _tx.state = TX_IDLE;
-            }
 #if defined(KNXTPUART_DEBUG_ERROR)
-            else DebugError("Rx: unexpected TPUART_DATA_CONFIRM_SUCCESS received!\n");
+          else DebugError("Rx: unexpected TPUART_DATA_CONFIRM_SUCCESS received!\n");
 #endif
+        }
+        // CASE OF TPUART_RESET NOTIFICATION
+        else if (incomingByte == TPUART_RESET_INDICATION)
+        {
+      
+          if ( (_tx.state == TX_TELEGRAM_SENDING_ONGOING ) || (_tx.state == TX_WAITING_ACK ) )
+          { // response to the TP UART transmission
+            _tx.ackFctPtr(TPUART_RESET_RESPONSE);
           }
-          // CASE OF TPUART_RESET NOTIFICATION
-          else if (incomingByte == TPUART_RESET_INDICATION)
-          {
-        
-            if ( (_tx.state == TX_TELEGRAM_SENDING_ONGOING ) || (_tx.state == TX_WAITING_ACK ) )
-            { // response to the TP UART transmission
-              _tx.ackFctPtr(TPUART_RESET_RESPONSE);
-            }
-           _tx.state = TX_STOPPED;
-           _rx.state = RX_STOPPED;
-           _evtCallbackFct(TPUART_EVENT_RESET); // Notify RESET
-           return;
-          }
-          // CASE OF STATE_INDICATION RESPONSE
-          else if ((incomingByte & TPUART_STATE_INDICATION_MASK) == TPUART_STATE_INDICATION)
-          {
-            _evtCallbackFct(TPUART_EVENT_STATE_INDICATION); // Notify STATE INDICATION
-            _stateIndication = incomingByte;
+         _tx.state = TX_STOPPED;
+         _rx.state = RX_STOPPED;
+         _evtCallbackFct(TPUART_EVENT_RESET); // Notify RESET
+         return;
+        }
+        // CASE OF STATE_INDICATION RESPONSE
+        else if ((incomingByte & TPUART_STATE_INDICATION_MASK) == TPUART_STATE_INDICATION)
+        {
+          _evtCallbackFct(TPUART_EVENT_STATE_INDICATION); // Notify STATE INDICATION
+          _stateIndication = incomingByte;
 #if defined(KNXTPUART_DEBUG_INFO)
-            DebugInfo("Rx: State Indication Received\n");
+          DebugInfo("Rx: State Indication Received\n");
 #endif
-          }
-          // CASE OF TPUART_DATA_CONFIRM_FAILED NOTIFICATION
-          else if (incomingByte == TPUART_DATA_CONFIRM_FAILED) 
+        }
+        // CASE OF TPUART_DATA_CONFIRM_FAILED NOTIFICATION
+        else if (incomingByte == TPUART_DATA_CONFIRM_FAILED) 
+        {
+          // NACK following Telegram transmission
+          if (_tx.state == TX_WAITING_ACK)
           {
-            // NACK following Telegram transmission
-            if (_tx.state == TX_WAITING_ACK)
-            {
-              _tx.ackFctPtr(NACK_RESPONSE);
-              _tx.state = TX_IDLE; 
-            }
+            RecordAckLatency(TimeDeltaWord((word)millis(), _tx.sentMessageTimeMillis));
+            _tx.ackFctPtr(NACK_RESPONSE);
+            _tx.state = TX_IDLE; 
+          }
 #if defined(KNXTPUART_DEBUG_ERROR)
-            else DebugError("Rx: unexpected TPUART_DATA_CONFIRM_FAILED received!\n");
+          else DebugError("Rx: unexpected TPUART_DATA_CONFIRM_FAILED received!\n");
 #endif
+        }
+#if defined(KNXTPUART_DEBUG_ERROR)
+        // UNKNOWN CONTROL FIELD RECEIVED
+        else if (incomingByte)
+          DebugError("Rx: Unknown Control Field received\n");
+#endif
+        // else ignore "0" value sent on Reset by TPUART prior to TPUART_RESET_INDICATION
+        break;
+
+    case RX_EIB_TELEGRAM_RECEPTION_STARTED :
+        RxAssemblySlot().telegram.WriteRawByte(incomingByte,_rx.readBytesNb);
+        _rx.readBytesNb++;
+
+        if (_rx.readBytesNb==3) 
+        {  // We have just received the source address
+           // we check whether the received EIB telegram is coming from us (i.e. telegram is sent by the TPUART itself)
+          if ( RxAssemblySlot().telegram.GetSourceAddress() == _physicalAddr )
+          { // the message is coming from us, we consider it as not addressed and we don't send any ACK service
+            _rx.state = RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED;
+          }
+        }
+        else if (_rx.readBytesNb==6) // We have just read the routing field containing the address type and the payload length
+        { // We check if the message is addressed to us in order to send the appropriate acknowledge
+          if(!IsAddressAssigned(RxAssemblySlot().telegram.GetTargetAddress()))
+          { // Message NOT addressed to us
+            _rx.state = RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED;
+            //sent the correct ACK service now
+            // the ACK info must be sent latest 1,7 ms after receiving the address type octet of an addressed frame
+            _serial.write(TPUART_RX_ACK_SERVICE_NOT_ADDRESSED);
           }
+          else if (_rxSlotsNb == KNXTPUART_RX_SLOTS_NB - 1)
+          { // Message addressed to us but all the slots are pending : we answer BUSY, the sender will repeat it
+            _rx.state = RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED;
+            _serial.write(TPUART_RX_ACK_SERVICE_BUSY);
 #if defined(KNXTPUART_DEBUG_ERROR)
-          // UNKNOWN CONTROL FIELD RECEIVED
-          else if (incomingByte)
-            DebugError("Rx: Unknown Control Field received\n");
+            DebugError("Rx: no free telegram slot, BUSY sent\n");
 #endif
-          // else ignore "0" value sent on Reset by TPUART prior to TPUART_RESET_INDICATION
-          break;
-
-      case RX_EIB_TELEGRAM_RECEPTION_STARTED :
-          telegram.WriteRawByte(incomingByte,readBytesNb);
-          readBytesNb++;
-
-          if (readBytesNb==3) 
-          {  // We have just received the source address
-             // we check whether the received EIB telegram is coming from us (i.e. telegram is sent by the TPUART itself)
-            if ( telegram.GetSourceAddress() == _physicalAddr )
-            { // the message is coming from us, we consider it as not addressed and we don't send any ACK service
-              _rx.state = RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED;
-            }
           }
-          else if (readBytesNb==6) // We have just read the routing field containing the address type and the payload length
-          { // We check if the message is addressed to us in order to send the appropriate acknowledge
-            if(IsAddressAssigned(telegram.GetTargetAddress(), addressedComObjectIndex))
-            { // Message addressed to us
-              _rx.state = RX_EIB_TELEGRAM_RECEPTION_ADDRESSED;
-              //sent the correct ACK service now
-              // the ACK info must be sent latest 1,7 ms after receiving the address type octet of an addressed frame
-              _serial.write(TPUART_RX_ACK_SERVICE_ADDRESSED);
-            }
-            else
-            { // Message NOT addressed to us
-              _rx.state = RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED;
-              //sent the correct ACK service now
-              // the ACK info must be sent latest 1,7 ms after receiving the address type octet of an addressed frame
-              _serial.write(TPUART_RX_ACK_SERVICE_NOT_ADDRESSED);
-            }
-          } 
-          break;
-
-      case RX_EIB_TELEGRAM_RECEPTION_ADDRESSED :
-          if (readBytesNb == KNX_TELEGRAM_MAX_SIZE) _rx.state = RX_EIB_TELEGRAM_RECEPTION_LENGTH_INVALID;
           else
-          {
-          telegram.WriteRawByte(incomingByte,readBytesNb);
-          readBytesNb++;
+          { // Message addressed to us
+            _rx.state = RX_EIB_TELEGRAM_RECEPTION_ADDRESSED;
+            //sent the correct ACK service now
+            // the ACK info must be sent latest 1,7 ms after receiving the address type octet of an addressed frame
+            _serial.write(TPUART_RX_ACK_SERVICE_ADDRESSED);
           }
-          break;
+        } 
+        break;
 
-    //  case RX_EIB_TELEGRAM_RECEPTION_LENGTH_INVALID : break; // if the message is too long, nothing to do except waiting for EOP
-    //  case RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED : break; // if the message is not addressed, nothing to do except waiting for EOP
+    case RX_EIB_TELEGRAM_RECEPTION_ADDRESSED :
+        if (_rx.readBytesNb == KNX_TELEGRAM_MAX_SIZE) _rx.state = RX_EIB_TELEGRAM_RECEPTION_LENGTH_INVALID;
+        else
+        {
+        RxAssemblySlot().telegram.WriteRawByte(incomingByte,_rx.readBytesNb);
+        _rx.readBytesNb++;
+        }
+        break;
+
+  //  case RX_EIB_TELEGRAM_RECEPTION_LENGTH_INVALID : break; // if the message is too long, nothing to do except waiting for EOP
+  //  case RX_EIB_TELEGRAM_RECEPTION_NOT_ADDRESSED : break; // if the message is not addressed, nothing to do except waiting for EOP
 
-      default : break;
-    } // switch (_rx.state)
-  } // if (_serial.available() > 0)
+    default : break;
+  } // switch (_rx.state)
 }
 
 
@@ -441,13 +581,14 @@ static word lastByteRxTimeMicrosec;
 // Assuming the TP-Uart speed is configured to 19200 baud, a character (8 data + 1 start + 1 parity + 1 stop)
 // is transmitted in 0,58ms.
 // Sending one byte of a telegram consists in transmitting 2 characters (1,16ms)
-// Let's wait around 800us between each telegram piece sending so that the 64byte TX buffer remains almost empty.
+// Up to KNXTPUART_TX_BURST_SIZE telegram bytes are written per call, as long as the UART TX buffer accepts them
+// and the TX buffer content does not exceed KNXTPUART_TX_MAX_BACKLOG_MICROS (so that a RX ACK is not delayed).
 // Typical calling period is 800 usec.
 void KnxTpUart::TXTask(void)
 {
 word nowTime;
 byte txByte[2];
-static word sentMessageTimeMillisec;
+byte burstNb;
 
   // STEP 1 : Manage Message Acknowledge timeout
   switch (_tx.state)
@@ -455,13 +596,16 @@ static word sentMessageTimeMillisec;
   case TX_WAITING_ACK :
     // A transmission ACK is awaited, increment Acknowledge timeout
     nowTime = (word) millis(); // word is enough to count up to 500
-    if(TimeDeltaWord(nowTime,sentMessageTimeMillisec) > 500 /* 500 ms */ )
+    if(TimeDeltaWord(nowTime,_tx.sentMessageTimeMillis) > _ackStats.ackTimeoutMillis)
     { // The no-answer timeout value is defined as follows :
       // - The emission duration for a single max sized telegram is 40ms
       // - The telegram emission might be repeated 3 times (120ms) 
       // - The telegram emission might be delayed by another message transmission ongoing
       // - The telegram emission might be delayed by the simultaneous transmission of higher prio messages
-      // Let's take around 3 times the max emission duration (160ms) as arbitrary value
+      // The timeout is derived from the measured latencies, between KNXTPUART_ACK_TIMEOUT_FLOOR (around 3 times
+      // the max emission duration) and KNXTPUART_ACK_TIMEOUT_CEILING
+      if (_ackStats.timeoutsNb < 0xFFFF) _ackStats.timeoutsNb++;
+      RecordAckLatency(KNXTPUART_ACK_TIMEOUT_CEILING); // a timeout counts as a ceiling latency sample
       _tx.ackFctPtr(NO_ANSWER_TIMEOUT); // Send a No Answer TIMEOUT
       _tx.state = TX_IDLE;
     }
@@ -472,28 +616,31 @@ static word sentMessageTimeMillisec;
     // In case a telegram reception has just started, and the ACK has not been sent yet,
     // we block the transmission (for around 3,3ms) till the ACK is sent
     // In that way, the TX buffer will remain empty and the ACK will be sent immediately
-    if (_rx.state != RX_EIB_TELEGRAM_RECEPTION_STARTED)
+    for (burstNb = 0; burstNb < KNXTPUART_TX_BURST_SIZE; burstNb++)
     {
-      {
-        if (_tx.nbRemainingBytes == 1)
-        { // We are sending the last byte, i.e checksum
-          txByte[0] = TPUART_DATA_END_REQ + _tx.txByteIndex;
-          txByte[1] = _tx.sentTelegram->ReadRawByte(_tx.txByteIndex);
-          _serial.write(txByte,2); // write the UART control field and the data byte
-
-          // Message sending completed
-          sentMessageTimeMillisec = (word)millis(); // memorize sending time in order to manage ACK timeout
-	  _tx.state = TX_WAITING_ACK;
-        }
-        else
-        {
-          txByte[0] = TPUART_DATA_START_CONTINUE_REQ + _tx.txByteIndex;
-          txByte[1] = _tx.sentTelegram->ReadRawByte(_tx.txByteIndex);
-          _serial.write(txByte,2); // write the UART control field and the data byte
-          _tx.txByteIndex++;
-          _tx.nbRemainingBytes--;
-        }
+      if (_rx.state == RX_EIB_TELEGRAM_RECEPTION_STARTED) break;
+      nowTime = (word) micros();
+      if (GetUartBacklogMicros(nowTime) + 2 * TPUART_CHAR_DURATION_MICROS > KNXTPUART_TX_MAX_BACKLOG_MICROS) break;
+      if (_serial.availableForWrite() < 2) break;
+
+      if (_tx.nbRemainingBytes == 1)
+      { // We are sending the last byte, i.e checksum
+        txByte[0] = TPUART_DATA_END_REQ + _tx.txByteIndex;
+        txByte[1] = _tx.sentTelegram->ReadRawByte(_tx.txByteIndex);
+        _serial.write(txByte,2); // write the UART control field and the data byte
+        _tx.uartEmptyTimeMicros = nowTime + GetUartBacklogMicros(nowTime) + 2 * TPUART_CHAR_DURATION_MICROS;
+
+        // Message sending completed
+        _tx.sentMessageTimeMillis = (word)millis(); // memorize sending time in order to manage ACK timeout
+        _tx.state = TX_WAITING_ACK;
+        break;
       }
+      txByte[0] = TPUART_DATA_START_CONTINUE_REQ + _tx.txByteIndex;
+      txByte[1] = _tx.sentTelegram->ReadRawByte(_tx.txByteIndex);
+      _serial.write(txByte,2); // write the UART control field and the data byte
+      _tx.uartEmptyTimeMicros = nowTime + GetUartBacklogMicros(nowTime) + 2 * TPUART_CHAR_DURATION_MICROS;
+      _tx.txByteIndex++;
+      _tx.nbRemainingBytes--;
     }
     break;
 	
@@ -502,6 +649,105 @@ static word sentMessageTimeMillisec;
 }
 
 
+// Add a sample to the ACK latency histogram and update the ACK timeout
+// The timeout is the 99th percentile latency plus KNXTPUART_ACK_TIMEOUT_MARGIN, bounded by
+// KNXTPUART_ACK_TIMEOUT_FLOOR and KNXTPUART_ACK_TIMEOUT_CEILING
+void KnxTpUart::RecordAckLatency(word latencyMillis)
+{
+word binIndex = latencyMillis / KNXTPUART_ACK_LATENCY_BIN_WIDTH;
+word threshold, cumulatedNb, timeout;
+byte i;
+
+  // Update the statistics
+  if (_ackStats.samplesNb < 0xFFFF) _ackStats.samplesNb++;
+  _ackStats.lastLatencyMillis = latencyMillis;
+  if (latencyMillis < _ackStats.minLatencyMillis) _ackStats.minLatencyMillis = latencyMillis;
+  if (latencyMillis > _ackStats.maxLatencyMillis) _ackStats.maxLatencyMillis = latencyMillis;
+
+  // Update the histogram
+  if (binIndex >= KNXTPUART_ACK_LATENCY_BINS_NB) binIndex = KNXTPUART_ACK_LATENCY_BINS_NB - 1;
+  if (_ackLatencyBins[binIndex] == 0xFF)
+  { // bin saturated, all the bins are halved (the oldest samples get less weight)
+    _ackLatencySamplesNb = 0;
+    for (i = 0; i < KNXTPUART_ACK_LATENCY_BINS_NB; i++)
+    {
+      _ackLatencyBins[i] >>= 1;
+      _ackLatencySamplesNb += _ackLatencyBins[i];
+    }
+  }
+  _ackLatencyBins[binIndex]++;
+  _ackLatencySamplesNb++;
+
+  // Get the 99th percentile (upper limit of the bin where 99% of the samples are reached)
+  threshold = _ackLatencySamplesNb - _ackLatencySamplesNb / 100;
+  cumulatedNb = 0;
+  for (i = 0; i < KNXTPUART_ACK_LATENCY_BINS_NB - 1; i++)
+  {
+    cumulatedNb += _ackLatencyBins[i];
+    if (cumulatedNb >= threshold) break;
+  }
+  _ackStats.p99LatencyMillis = (i + 1) * KNXTPUART_ACK_LATENCY_BIN_WIDTH;
+
+  // Update the ACK timeout
+  if (_ackStats.samplesNb < KNXTPUART_ACK_LATENCY_MIN_SAMPLES) return; // not enough samples yet
+  timeout = _ackStats.p99LatencyMillis + KNXTPUART_ACK_TIMEOUT_MARGIN;
+  if (timeout < KNXTPUART_ACK_TIMEOUT_FLOOR) timeout = KNXTPUART_ACK_TIMEOUT_FLOOR;
+  if (timeout > KNXTPUART_ACK_TIMEOUT_CEILING) timeout = KNXTPUART_ACK_TIMEOUT_CEILING;
+  _ackStats.ackTimeoutMillis = timeout;
+}
+
+
+// Get the estimated duration (in usec) of the characters waiting in the UART TX buffer
+word KnxTpUart::GetUartBacklogMicros(word nowTime) const
+{
+  word backlog = TimeDeltaWord(_tx.uartEmptyTimeMicros, nowTime);
+  if (backlog > 0x8000) return 0; // the UART TX buffer empty time is over
+  return backlog;
+}
+
+
+// Get the delay (in usec) before RXTask() has some work to do
+unsigned long KnxTpUart::GetRXTaskDelayMicros(void)
+{
+word elapsedTime;
+
+  if (RxRingElementsNb()) return 0; // received data is waiting
+#ifndef KNXTPUART_RX_ISR_FEED
+  if (_serial.available() > 0) return 0;
+#endif
+  if (_rx.state >= RX_EIB_TELEGRAM_RECEPTION_STARTED)
+  { // a telegram reception is ongoing, the EOP is detected 2ms after the last received byte
+    elapsedTime = TimeDeltaWord((word)micros(), _rx.lastByteRxTimeMicros);
+    if (elapsedTime > 2000) return 0;
+    return (2000 + 1 - elapsedTime);
+  }
+  return KNX_TPUART_NO_DEADLINE;
+}
+
+
+// Get the delay (in usec) before TXTask() has some work to do
+unsigned long KnxTpUart::GetTXTaskDelayMicros(void) const
+{
+word elapsedTime, backlogTime;
+
+  switch (_tx.state)
+  {
+    case TX_TELEGRAM_SENDING_ONGOING :
+      // the next telegram byte is written once the UART TX buffer content is low enough
+      backlogTime = GetUartBacklogMicros((word)micros()) + 2 * TPUART_CHAR_DURATION_MICROS;
+      if (backlogTime <= KNXTPUART_TX_MAX_BACKLOG_MICROS) return 0;
+      return backlogTime - KNXTPUART_TX_MAX_BACKLOG_MICROS;
+
+    case TX_WAITING_ACK :
+      elapsedTime = TimeDeltaWord((word)millis(), _tx.sentMessageTimeMillis);
+      if (elapsedTime > _ackStats.ackTimeoutMillis) return 0;
+      return (_ackStats.ackTimeoutMillis + 1 - elapsedTime) * 1000UL;
+
+    default : return KNX_TPUART_NO_DEADLINE;
+  }
+}
+
+
 // Get Bus monitoring data (BUS MONITORING mode)
 // The function returns true if a new data has been retrieved (data pointer in argument), else false
 // It shall be called periodically (max period of 0,5ms) in order to allow correct data reception
@@ -509,69 +755,159 @@ static word sentMessageTimeMillisec;
 boolean KnxTpUart::GetMonitoringData(type_MonitorData& data)
 {
 word nowTime;
+type_tpuart_rx_byte rxByte;
 static type_MonitorData currentData={true,0};
-static word lastByteRxTimeMicrosec;
 
-  // STEP 1 : Check EOP
-  if (!(currentData.isEOP)) // check that we have not already detected an EOP
+#ifndef KNXTPUART_RX_ISR_FEED
+  ReadSerialBytes();
+#endif
+  nowTime = (word) micros(); // word cast because a 65ms counter is enough
+
+  // STEP 1 : Get New RX Data
+  if (PeekRxByte(rxByte))
   {
-    nowTime = (word) micros(); // word cast because a 65ms counter is enough
-    if(TimeDeltaWord(nowTime,lastByteRxTimeMicrosec) > 2000 /* 2 ms */ )
-    {  // EOP detected
+    if ( !(currentData.isEOP) && (TimeDeltaWord(rxByte.timeMicros, _rx.lastByteRxTimeMicros) > 2000 /* 2 ms */ ) )
+    { // EOP detected prior to the new byte, the byte is kept in the ring for next call
       currentData.isEOP = true;
       currentData.dataByte = 0;
       data= currentData;
       return true;
     }
-  }
-  // STEP 2 : Get New RX Data
-  if (_serial.available() > 0) 
-  {
-    currentData.dataByte = (byte)(_serial.read());
+    PopRxByte(rxByte);
+    currentData.dataByte = rxByte.data;
     currentData.isEOP = false;
     data= currentData;
-    lastByteRxTimeMicrosec = (word) micros();
+    _rx.lastByteRxTimeMicros = rxByte.timeMicros;
     return true;
   }
+
+  // STEP 2 : Check EOP
+  if (!(currentData.isEOP)) // check that we have not already detected an EOP
+  {
+    if(TimeDeltaWord(nowTime,_rx.lastByteRxTimeMicros) > 2000 /* 2 ms */ )
+    {  // EOP detected
+      currentData.isEOP = true;
+      currentData.dataByte = 0;
+      data= currentData;
+      return true;
+    }
+  }
   return false; // No data received
 }
 
 
+// Build the address lookup structure (bitmap or hash table) from the ordered @ table
+// return false in case of memory allocation failure
+boolean KnxTpUart::BuildAddressLookup(void)
+{
+#if defined(KNXTPUART_ADDR_LOOKUP_BITMAP)
+word addr;
+
+  _addrBitmap = (byte*) calloc(KNXTPUART_ADDR_BITMAP_SIZE, 1);
+  if (!_addrBitmap) return false;
+  for (word i = 0; i < _assignedAddrsNb; i++)
+  {
+    addr = _orderedAddrTable[i].addr;
+    _addrBitmap[addr >> 3] |= (1 << (addr & 7));
+  }
+#elif defined(KNXTPUART_ADDR_LOOKUP_HASH)
+word addr, slot, mask;
+
+  // table size is the smallest power of 2 at least twice the nb of entries (load factor <= 0.5), 65536 max
+  for (_addrHashBits = 1; (_addrHashBits < 16) && ((1UL << _addrHashBits) < 2UL * _assignedAddrsNb); _addrHashBits++);
+  _addrHashTable = (word*) calloc(1UL << _addrHashBits, sizeof(word));
+  if (!_addrHashTable) return false;
+  mask = (word)((1UL << _addrHashBits) - 1);
+  for (word i = 0; i < _assignedAddrsNb; i++)
+  { // one entry per address, pointing to the 1st object of the address fan-out list
+    addr = _orderedAddrTable[i].addr;
+    if (i && (_orderedAddrTable[i - 1].addr == addr)) continue;
+    // linear probing till an empty slot is found
+    slot = (word)((word)(addr * KNXTPUART_ADDR_HASH_MULTIPLIER) >> (16 - _addrHashBits));
+    while (_addrHashTable[slot]) slot = (slot + 1) & mask;
+    _addrHashTable[slot] = i + 1;
+  }
+#endif
+  return true;
+}
+
+
+// Free the address lookup structure
+void KnxTpUart::FreeAddressLookup(void)
+{
+#if defined(KNXTPUART_ADDR_LOOKUP_BITMAP)
+  if (_addrBitmap) free(_addrBitmap);
+  _addrBitmap = NULL;
+#elif defined(KNXTPUART_ADDR_LOOKUP_HASH)
+  if (_addrHashTable) free(_addrHashTable);
+  _addrHashTable = NULL;
+  _addrHashBits = 0;
+#endif
+}
+
+
 // Check if the target address is an assigned com object one
-// if yes, then update index parameter with the index (in the list) of the targeted com object and return true
-// else return false
-boolean KnxTpUart::IsAddressAssigned(word addr, byte &index) const
+// This is the RX ACK decision, its execution time is constant with the BITMAP and HASH lookup flags
+boolean KnxTpUart::IsAddressAssigned(word addr) const
 {
-byte divisionCounter=0;
-byte i, searchIndexStart, searchIndexStop, searchIndexRange;
+#if defined(KNXTPUART_ADDR_LOOKUP_BITMAP)
+  if (!_addrBitmap) return false;
+  return ((_addrBitmap[addr >> 3] & (1 << (addr & 7))) != 0);
+#else
+word tableIndex;
 
-  if (!_assignedComObjectsNb) return false; // in case of empty list, we return immediately
+  return FindFirstAddrEntry(addr, tableIndex); // hit test only, the fan-out list is resolved at EOP
+#endif
+}
 
-  // Define how many divisions by 2 shall be done in order to reduce the search list by 8 Addr max
-  // if _assignedComObjectsNb >= 16 => divisionCounter = 1
-  // if _assignedComObjectsNb >= 32 => divisionCounter = 2
-  // if _assignedComObjectsNb >= 64 => divisionCounter = 3
-  // if _assignedComObjectsNb >= 128 => divisionCounter = 4    
-  for (i=4; _assignedComObjectsNb >>i ; i++) divisionCounter++; 
 
-  // the starting point is to search on the whole address range (0 -> _assignedComObjectsNb -1)
-  searchIndexStart = 0; searchIndexStop = _assignedComObjectsNb - 1; searchIndexRange = _assignedComObjectsNb;
-  
-  // reduce the address range if needed
-  while(divisionCounter)
-  { 
-    searchIndexRange>>=1; // Divide range width by 2
-    if ( addr >= _comObjectsList[_orderedIndexTable[searchIndexStart+searchIndexRange]].GetAddr())
-      searchIndexStart += searchIndexRange ;
-    else searchIndexStop-=searchIndexRange;
-    divisionCounter --;
+// Find the 1st pair of the target address in the ordered @ table
+// if found, then update "tableIndex" with its position and return true, else return false
+boolean KnxTpUart::FindFirstAddrEntry(word addr, word &tableIndex) const
+{
+word first;
+#if defined(KNXTPUART_ADDR_LOOKUP_HASH)
+word slot, mask, entry;
+
+  if (!_addrHashTable) return false; // in case of empty list, we return immediately
+
+  mask = (word)((1UL << _addrHashBits) - 1);
+  slot = (word)((word)(addr * KNXTPUART_ADDR_HASH_MULTIPLIER) >> (16 - _addrHashBits));
+  // the table is never full, the probing ends on an empty slot at the latest
+  while (((entry = _addrHashTable[slot]) != 0) && (_orderedAddrTable[entry - 1].addr != addr))
+    slot = (slot + 1) & mask;
+  if (!entry) return false; // Address is NOT part of the assigned addresses
+  first = entry - 1;
+#else
+word searchIndexStop, searchIndexMiddle;
+
+  if (!_assignedAddrsNb) return false; // in case of empty list, we return immediately
+
+  // search the lowest position with an address greater or equal to addr, in the range [first, stop[
+  first = 0; searchIndexStop = _assignedAddrsNb;
+  while (first < searchIndexStop)
+  {
+    searchIndexMiddle = first + ((searchIndexStop - first) >> 1);
+    if (_orderedAddrTable[searchIndexMiddle].addr < addr) first = searchIndexMiddle + 1;
+    else searchIndexStop = searchIndexMiddle;
   }
-  
-  // search the address value and index in the reduced range
-  for (i = searchIndexStart; ((_comObjectsList[_orderedIndexTable[i]].GetAddr() != addr) && (i <= searchIndexStop)); i++);
-  if (i > searchIndexStop) return false; // Address is NOT part of the assigned addresses
-  // Address is part of the assigned addresses
-  index = _orderedIndexTable[i];
+  if ((first == _assignedAddrsNb) || (_orderedAddrTable[first].addr != addr))
+    return false; // Address is NOT part of the assigned addresses
+#endif
+  tableIndex = first;
+  return true;
+}
+
+
+// Find the com objects assigned to the target address
+// if found, then update "tableIndex" with the position (in the ordered @ table) of the 1st targeted com object,
+// "nb" with the nb of targeted com objects, and return true
+// else return false
+boolean KnxTpUart::FindComObjects(word addr, word &tableIndex, type_ComObjectIndex &nb) const
+{
+  if (!FindFirstAddrEntry(addr, tableIndex)) return false;
+  // Address is part of the assigned addresses, the fan-out list length is computed at attachment
+  nb = _orderedAddrTable[tableIndex].fanOutNb;
   return true;
 }
 
@@ -40,6 +40,63 @@
 // DEBUG :
 // #define KNXTPUART_DEBUG_INFO   // Uncomment to activate info traces
 // #define KNXTPUART_DEBUG_ERROR  // Uncomment to activate error traces
+// RX FEED :
+// #define KNXTPUART_RX_ISR_FEED  // Uncomment when the received bytes are pushed by a UART ISR or a reader thread
+                                  // (see PushRxByte()), else RXTask() reads them from the serial port
+
+// Size of the RX byte ring (power of 2, 128 max) :
+// the ring holds the received bytes (with their reception time) not yet treated by RXTask()
+#define KNXTPUART_RX_RING_SIZE 32
+#if (KNXTPUART_RX_RING_SIZE & (KNXTPUART_RX_RING_SIZE - 1)) || (KNXTPUART_RX_RING_SIZE > 128)
+#error "KNXTPUART_RX_RING_SIZE shall be a power of 2, 128 max"
+#endif
+
+// Nb of RX telegram slots (2 min) : a telegram is assembled directly in a free slot, then handed over to the
+// application (no copy) till it gets released. Up to KNXTPUART_RX_SLOTS_NB-1 received telegrams are pending,
+// when they are all pending, a new addressed telegram is answered with a BUSY ACK (the sender repeats it)
+#define KNXTPUART_RX_SLOTS_NB 4
+#if (KNXTPUART_RX_SLOTS_NB < 2)
+#error "KNXTPUART_RX_SLOTS_NB shall be 2 min"
+#endif
+
+// Max duration (usec) of the characters waiting in the UART TX buffer.
+// A RX ACK service written while our telegram bytes are queued gets delayed by that duration : once a reception
+// is started, TXTask() stops writing, and the queue empties while the 5 bytes preceding the routing octet
+// are received (2,9ms). The ACK service shall then be sent latest 1,7ms after the routing octet reception.
+#define KNXTPUART_TX_MAX_BACKLOG_MICROS 2500
+
+// Duration (usec) of a character at 19200 baud (8 data + 1 start + 1 parity + 1 stop)
+#define TPUART_CHAR_DURATION_MICROS 573
+
+// TX burst : max nb of telegram bytes (i.e. control field + data byte pairs) written to the UART per TXTask() call
+// It is derived from the backlog cap, which governs the burst (2 telegram bytes with the values above)
+#define KNXTPUART_TX_BURST_SIZE (KNXTPUART_TX_MAX_BACKLOG_MICROS / (2 * TPUART_CHAR_DURATION_MICROS))
+#if (KNXTPUART_TX_BURST_SIZE < 1)
+#error "KNXTPUART_TX_MAX_BACKLOG_MICROS shall hold one telegram byte (2 characters) min"
+#endif
+
+// Adaptive ACK timeout : the latencies between the telegram sending and the TPUART data confirm are measured
+// (histogram of KNXTPUART_ACK_LATENCY_BINS_NB bins), the ACK timeout is the 99th percentile latency plus a margin,
+// bounded by a floor and a ceiling. Each timeout counts as a sample of ceiling latency, so that the timeout
+// gets back up when the confirms are late.
+#define KNXTPUART_ACK_TIMEOUT_FLOOR         160 // Min ACK timeout (msec) : 3 max sized telegram emissions + repetitions
+#define KNXTPUART_ACK_TIMEOUT_CEILING       500 // Max ACK timeout (msec), used till enough latencies are measured
+#define KNXTPUART_ACK_TIMEOUT_MARGIN        40  // Margin (msec) added to the 99th percentile latency
+#define KNXTPUART_ACK_LATENCY_MIN_SAMPLES   32  // Nb of measured latencies required prior to adapting the timeout
+#define KNXTPUART_ACK_LATENCY_BIN_WIDTH     16  // Width (msec) of a histogram bin
+#define KNXTPUART_ACK_LATENCY_BINS_NB       32  // Nb of histogram bins (the last bin gathers the longer latencies)
+
+// GROUP ADDRESS LOOKUP :
+// The RX ACK decision (is the received telegram addressed to us?) shall be taken within 1,7ms.
+// By default, a binary search is done in the ordered com objects table (log2(n) address comparisons).
+// Uncomment one of the flags below to get a constant time decision, depending on the available RAM :
+// #define KNXTPUART_ADDR_LOOKUP_BITMAP // 8 KB bitmap (one bit per group address), for boards with large RAM
+// #define KNXTPUART_ADDR_LOOKUP_HASH   // open addressing hash table, 2 to 4 slots (of type_ComObjectIndex) per com object
+#if defined(KNXTPUART_ADDR_LOOKUP_BITMAP) && defined(KNXTPUART_ADDR_LOOKUP_HASH)
+#error "KNXTPUART_ADDR_LOOKUP_BITMAP and KNXTPUART_ADDR_LOOKUP_HASH flags are exclusive"
+#endif
+#define KNXTPUART_ADDR_BITMAP_SIZE     8192  // Size (bytes) of the address bitmap (65536 group addresses)
+#define KNXTPUART_ADDR_HASH_MULTIPLIER 40503U // 2^16 / golden ratio (Fibonacci hashing of the 16 bits addresses)
 
 
 // Values returned by the KnxTpUart member functions :
@@ -49,6 +106,9 @@
 #define KNX_TPUART_ERROR_NULL_EVT_CALLBACK_FCT 253
 #define KNX_TPUART_ERROR_NULL_ACK_CALLBACK_FCT 252
 
+// Value returned by the task delay functions when no deadline is pending
+#define KNX_TPUART_NO_DEADLINE 0xFFFFFFFF
+
 
 // Services to TPUART (hostcontroller -> TPUART) :
 #define TPUART_RESET_REQ                     0x01
@@ -59,6 +119,7 @@
 #define TPUART_ACTIVATEBUSMON_REQ            0x05
 #define TPUART_RX_ACK_SERVICE_ADDRESSED      0x11
 #define TPUART_RX_ACK_SERVICE_NOT_ADDRESSED  0x10
+#define TPUART_RX_ACK_SERVICE_BUSY           0x13
 
 
 // Services from TPUART (TPUART -> hostcontroller) :
@@ -111,12 +172,30 @@ enum e_TpUartRxState {
 
 typedef struct {
   e_TpUartRxState state;        // Current TPUART RX state
-  KnxTelegram receivedTelegram; // Where each received telegram is stored (the content is overwritten on each telegram reception)
-                                // A TPUART_EVENT_RECEIVED_EIB_TELEGRAM event notifies each content change
-  byte addressedComObjectIndex; // Where the index to the targeted com object is stored (the value is overwritten on each telegram reception)
-                                // A TPUART_EVENT_RECEIVED_EIB_TELEGRAM event notifies each content change
+  word lastByteRxTimeMicros;    // Time (in usec) of the last received byte, used for End Of Packet detection
+  byte readBytesNb;             // Nb of read bytes during an EIB telegram reception
 } type_tpuart_rx;
 
+// RX telegram slot : the telegram is assembled in the slot, then the slot is handed over to the application
+typedef struct {
+  KnxTelegram telegram;                       // Received telegram
+  word addressedTableIndex;                   // Position (in the ordered @ table) of the 1st targeted com object
+  type_ComObjectIndex addressedComObjectsNb;  // Nb of targeted com objects
+} type_tpuart_rx_slot;
+
+// Entry of the ordered @ table : a listening address of a com object
+typedef struct {
+  word addr;                    // Listening address (the sending one or an additional one)
+  type_ComObjectIndex index;    // Index (in the list) of the com object
+  type_ComObjectIndex fanOutNb; // Nb of pairs sharing the address, set on the 1st pair of the run only (0 on the others)
+} type_tpuart_addr_entry;
+
+// Received byte, stamped with its reception time
+typedef struct {
+  byte data;
+  word timeMicros; // Time (in usec) of the byte reception
+} type_tpuart_rx_byte;
+
 // --- Definitions for the TRANSMISSION  part ----
 // Transmission states
 enum e_TpUartTxState {
@@ -145,9 +224,23 @@ typedef struct tpuart_tx {
   type_AckCallbackFctPtr ackFctPtr; // Pointer to callback function for TX ack
   byte nbRemainingBytes;            // Nb of bytes remaining to be transmitted
   byte txByteIndex;                 // Index of the byte to be sent
+  word sentMessageTimeMillis;       // Time (in msec) of the telegram sending completion, used for ACK timeout
+  word uartEmptyTimeMicros;         // Estimated time (in usec) when the UART TX buffer gets empty
 } type_tpuart_tx;
 
 
+// ACK latency statistics
+typedef struct {
+  word samplesNb;          // Nb of measured latencies (saturated counter)
+  word timeoutsNb;         // Nb of ACK timeouts (saturated counter)
+  word lastLatencyMillis;  // Last measured latency (msec)
+  word minLatencyMillis;   // Min measured latency (msec)
+  word maxLatencyMillis;   // Max measured latency (msec)
+  word p99LatencyMillis;   // 99th percentile latency (msec), histogram bin resolution
+  word ackTimeoutMillis;   // Current ACK timeout (msec)
+} type_tpuart_ack_stats;
+
+
 // --- Typdef for BUS MONITORING mode data ----
 typedef struct {
   boolean isEOP;  // True if the data is an End Of Packet
@@ -163,9 +256,27 @@ class KnxTpUart {
     type_tpuart_tx _tx;                       // Transmission structure
     type_EventCallbackFctPtr _evtCallbackFct; // Pointer to the EVENTS callback function
     KnxComObject *_comObjectsList;            // Attached list of com objects
-    byte _assignedComObjectsNb;               // Nb of assigned com objects
-    byte *_orderedIndexTable;                 // Table containing the assigned com objects indexes ordered by increasing @
+    word _assignedAddrsNb;                    // Nb of assigned (@, com object) pairs
+    type_ComObjectIndex _maxFanOutNb;         // Max nb of com objects sharing a listening @ (largest fan-out list)
+    type_tpuart_addr_entry *_orderedAddrTable; // Table containing the listening @ of the com objects, ordered by increasing @
+                                              // (the objects sharing an @ are contiguous, i.e. the @ fan-out list)
+#if defined(KNXTPUART_ADDR_LOOKUP_BITMAP)
+    byte *_addrBitmap;                        // One bit per group address, set when the address is assigned
+#elif defined(KNXTPUART_ADDR_LOOKUP_HASH)
+    word *_addrHashTable;                     // Hash table of the assigned @ (position + 1 in the ordered @ table, 0 for an empty slot)
+    byte _addrHashBits;                       // log2 of the hash table size
+#endif
     byte _stateIndication;                    // Value of the last received state indication
+    word _busTelegramsNb;                     // Nb of telegrams seen on the bus (addressed or not), rolling counter
+    type_tpuart_rx_slot _rxSlots[KNXTPUART_RX_SLOTS_NB]; // RX telegram slots (pending telegrams followed by the assembly slot)
+    byte _rxSlotsHead;                        // Index of the oldest pending telegram slot
+    byte _rxSlotsNb;                          // Nb of pending (i.e. received and not released) telegrams
+    type_tpuart_rx_byte _rxRing[KNXTPUART_RX_RING_SIZE]; // Received bytes not yet treated (lock-free single producer/single consumer ring)
+    volatile byte _rxRingHead;                // Free running index of the next byte to be treated (written by RXTask only)
+    volatile byte _rxRingTail;                // Free running index of the next byte to be received (written by the producer only)
+    byte _ackLatencyBins[KNXTPUART_ACK_LATENCY_BINS_NB]; // Histogram of the ACK latencies (all the bins are halved when one saturates)
+    word _ackLatencySamplesNb;                // Nb of samples in the histogram
+    type_tpuart_ack_stats _ackStats;          // ACK latency statistics
 #if defined(KNXTPUART_DEBUG_INFO) || defined(KNXTPUART_DEBUG_ERROR)
     String *_debugStrPtr;
 #endif
@@ -203,12 +314,40 @@ static const char _debugErrorText[];
     // NB : every state indication value change is notified by a "TPUART_EVENT_STATE_INDICATION" event
     byte GetStateIndication(void) const;
 
-    // Get the reference to the telegram received by the TPUART
-    // NB : every received telegram content change is notified by a "TPUART_EVENT_RECEIVED_EIB_TELEGRAM" event
+    // Get the nb of received telegrams pending (i.e. not released yet)
+    // NB : every telegram reception is notified by a "TPUART_EVENT_RECEIVED_EIB_TELEGRAM" event
+    byte GetReceivedTelegramsNb(void) const;
+
+    // Get the reference to the oldest pending received telegram (shall be called only when GetReceivedTelegramsNb() > 0)
+    // The telegram is stored in a RX slot and stays unchanged till ReleaseReceivedTelegram() is called
     KnxTelegram& GetReceivedTelegram(void);
 
-    // Get the index of the com object targeted by the last received telegram
-    byte GetTargetedComObjectIndex(void) const;
+    // Get the nb of com objects targeted by the oldest pending received telegram (i.e. sharing the target address)
+    type_ComObjectIndex GetTargetedComObjectsNb(void) const;
+
+    // Get the index of a com object targeted by the oldest pending received telegram
+    // "rank" is the rank among the targeted objects (lower than GetTargetedComObjectsNb()),
+    // the objects are ranked by increasing index
+    type_ComObjectIndex GetTargetedComObjectIndex(type_ComObjectIndex rank) const;
+
+    // Release the oldest pending received telegram, its slot gets available for a new reception
+    void ReleaseReceivedTelegram(void);
+
+    // Get the max nb of com objects targeted by a telegram, i.e. the length of the largest address fan-out list
+    type_ComObjectIndex GetMaxTargetedComObjectsNb(void) const;
+
+    // Get the nb of telegrams seen on the bus (addressed to us or not) since the TPUART creation
+    // NB : the counter rolls over, use differences between 2 values to measure the bus load
+    word GetBusTelegramsNb(void) const;
+
+    // Push a received byte with its reception time (usec) in the RX ring
+    // The function is intended to be called by the UART ISR or by a reader thread (KNXTPUART_RX_ISR_FEED option),
+    // it is safe as long as there is one producer only. Reception then gets independent of the RXTask() calling period.
+    // Return false when the ring is full (the byte is lost)
+    boolean PushRxByte(byte data, word timeMicros);
+
+    // Get the ACK latency statistics (see KNXTPUART_ACK_xxx defines)
+    const type_tpuart_ack_stats& GetAckStats(void) const;
 
     // returns true if there is an activity ongoing (RX/TX) on the TPUART
     // false when there's no activity or when the tpuart is not initialized
@@ -226,10 +365,12 @@ static const char _debugErrorText[];
 
     // Attach a list of com objects
     // NB1 : only the objects with "communication" attribute are considered by the TPUART
-    // NB2 : In case of objects with identical address, the object with highest index only is considered
+    // NB2 : Several objects may share the same address, a telegram with that address targets all of them
+    // NB3 : The objects listen to their address and to their additional listening addresses
     // return KNX_TPUART_ERROR_NOT_INIT_STATE (254) if the TPUART is not in Init state
     // The function must be called prior to Init() execution
-    byte AttachComObjectsList(KnxComObject KnxComObjectsList[], byte listSize);
+    // The attach (sort) time is O(n log n), the address lookup time is O(log n) or O(1) (see GROUP ADDRESS LOOKUP flags)
+    byte AttachComObjectsList(KnxComObject KnxComObjectsList[], type_ComObjectIndex listSize);
 
     // Init
     // returns ERROR (255) if the TP-UART is not in INIT state, else returns OK (0)
@@ -245,8 +386,10 @@ static const char _debugErrorText[];
     // This function shall be called periodically in order to allow a correct reception of the EIB bus data
     // Assuming the TPUART speed is configured to 19200 baud, a character (8 data + 1 start + 1 parity + 1 stop)
     // is transmitted in 0,58ms.
-    // In order not to miss any End Of Packets (i.e. a gap from 2 to 2,5ms), the function shall be called at a max period of 0,5ms.
-    // Typical calling period is 400 usec.
+    // All the pending received bytes are treated, the End Of Packets (i.e. a gap from 2 to 2,5ms) are detected
+    // using the bytes reception times.
+    // Without KNXTPUART_RX_ISR_FEED option, the bytes are time stamped when read by the function, it shall then
+    // be called at a max period of 0,5ms. Typical calling period is 400 usec.
     void RXTask(void);
 
     // Transmission task
@@ -254,10 +397,22 @@ static const char _debugErrorText[];
     // Assuming the TP-Uart speed is configured to 19200 baud, a character (8 data + 1 start + 1 parity + 1 stop)
     // is transmitted in 0,58ms.
     // Sending one byte of a telegram consists in transmitting 2 characters (1,16ms)
-    // Let's wait around 800us between each telegram piece sending so that the 64byte TX buffer remains almost empty.
+    // Up to KNXTPUART_TX_BURST_SIZE telegram bytes are written per call, as long as the UART TX buffer accepts them
+    // and the TX buffer content does not exceed KNXTPUART_TX_MAX_BACKLOG_MICROS (so that a RX ACK is not delayed).
     // Typical calling period is 800 usec.
     void TXTask(void);
 
+    // Get the delay (in usec) before RXTask() has some work to do :
+    // 0 when received data is waiting, the delay till End Of Packet detection when a telegram reception is ongoing,
+    // else KNX_TPUART_NO_DEADLINE (the data arrival is not predictable, the host shall wake up on UART reception)
+    unsigned long GetRXTaskDelayMicros(void);
+
+    // Get the delay (in usec) before TXTask() has some work to do :
+    // the delay till the next telegram bytes can be written when a telegram sending is ongoing,
+    // the delay till ACK timeout when an ACK is awaited (see GetAckStats()),
+    // else KNX_TPUART_NO_DEADLINE
+    unsigned long GetTXTaskDelayMicros(void) const;
+
     // Get Bus monitoring data (BUS MONITORING mode)
     // The function returns true if a new data has been retrieved (data pointer in argument), else false
     // It shall be called periodically (max period of 0,5ms) in order to allow correct data reception
@@ -278,11 +433,54 @@ static const char _debugErrorText[];
     void DebugError(const char[]) const;
 #endif
 
+    // Slot where the telegram being received is assembled (the one following the pending telegrams)
+    type_tpuart_rx_slot& RxAssemblySlot(void);
+
+    // Get the index of the com object at position "tableIndex" in the ordered @ table
+    type_ComObjectIndex GetAddrTableComObjectIndex(word tableIndex) const;
+
+    // RX ring management
+    byte RxRingElementsNb(void) const;
+    boolean PeekRxByte(type_tpuart_rx_byte& rxByte) const;
+    boolean PopRxByte(type_tpuart_rx_byte& rxByte);
+
   // Private NOT INLINED functions 
+    // Move the bytes received by the serial port to the RX ring (stamped with the current time)
+    void ReadSerialBytes(void);
+
+    // Treat a received byte (RX state machine)
+    void ReceiveByte(byte incomingByte);
+
+    // Treat an End Of Packet (the telegram reception is completed)
+    void EndOfPacket(void);
+
+    // Add a sample to the ACK latency histogram and update the ACK timeout
+    void RecordAckLatency(word latencyMillis);
+
+    // Get the estimated duration (in usec) of the characters waiting in the UART TX buffer
+    word GetUartBacklogMicros(word nowTime) const;
+
+    // Build the address lookup structure (bitmap or hash table) from the ordered @ table
+    // return false in case of memory allocation failure
+    boolean BuildAddressLookup(void);
+
+    // Free the address lookup structure
+    void FreeAddressLookup(void);
+
     // Check if the target address points to an assigned com object (i.e. the target address equals a com object address)
-    // if yes, then update index parameter with the index (in the list) of the targeted com object and return true
+    // This is the RX ACK decision, its execution time is constant with the BITMAP and HASH lookup flags
+    // (the targeted com objects are not searched, see FindComObjects())
+    boolean IsAddressAssigned(word addr) const;
+
+    // Find the 1st pair of the target address in the ordered @ table (hash table probe or binary search)
+    // if found, then update "tableIndex" with its position and return true, else return false
+    boolean FindFirstAddrEntry(word addr, word &tableIndex) const;
+
+    // Find the com objects assigned to the target address
+    // if found, then update "tableIndex" with the position (in the ordered @ table) of the 1st targeted com object,
+    // "nb" with the nb of targeted com objects, and return true
     // else return false
-    boolean IsAddressAssigned(word addr, byte &index) const;
+    boolean FindComObjects(word addr, word &tableIndex, type_ComObjectIndex &nb) const;
 };
 
 
@@ -306,12 +504,78 @@ inline byte KnxTpUart::SetAckCallback(type_AckCallbackFctPtr ackFctPtr)
 
 inline byte KnxTpUart::GetStateIndication(void) const { return _stateIndication; }
 
+inline byte KnxTpUart::GetReceivedTelegramsNb(void) const { return _rxSlotsNb; }
+
 inline KnxTelegram& KnxTpUart::GetReceivedTelegram(void)
-{ return _rx.receivedTelegram; }
+{ return _rxSlots[_rxSlotsHead].telegram; }
+
+
+inline type_ComObjectIndex KnxTpUart::GetTargetedComObjectsNb(void) const
+{ return _rxSlots[_rxSlotsHead].addressedComObjectsNb; } // return the nb of objects addressed by the received KNX Telegram
+
+inline type_ComObjectIndex KnxTpUart::GetMaxTargetedComObjectsNb(void) const { return _maxFanOutNb; }
+
+inline type_ComObjectIndex KnxTpUart::GetTargetedComObjectIndex(type_ComObjectIndex rank) const
+{ return GetAddrTableComObjectIndex(_rxSlots[_rxSlotsHead].addressedTableIndex + rank); } // return the index of an object addressed by the received KNX Telegram
+
+inline void KnxTpUart::ReleaseReceivedTelegram(void)
+{
+  if (!_rxSlotsNb) return;
+  _rxSlotsHead = (_rxSlotsHead + 1) % KNXTPUART_RX_SLOTS_NB;
+  _rxSlotsNb--;
+}
+
+inline type_ComObjectIndex KnxTpUart::GetAddrTableComObjectIndex(word tableIndex) const
+{ return _orderedAddrTable[tableIndex].index; }
+
+inline type_tpuart_rx_slot& KnxTpUart::RxAssemblySlot(void)
+{ return _rxSlots[(_rxSlotsHead + _rxSlotsNb) % KNXTPUART_RX_SLOTS_NB]; }
 
 
-inline byte KnxTpUart::GetTargetedComObjectIndex(void) const
-{ return _rx.addressedComObjectIndex; } // return the index of the adress addressed by the received KNX Telegram
+inline word KnxTpUart::GetBusTelegramsNb(void) const { return _busTelegramsNb; }
+
+inline const type_tpuart_ack_stats& KnxTpUart::GetAckStats(void) const { return _ackStats; }
+
+
+// Memory barrier ordering the ring data accesses and the ring indexes update
+#if defined(__AVR__)
+#define KNXTPUART_RX_RING_BARRIER() __asm__ __volatile__ ("" ::: "memory") // single core, compiler barrier is enough
+#else
+#define KNXTPUART_RX_RING_BARRIER() __sync_synchronize()
+#endif
+
+inline boolean KnxTpUart::PushRxByte(byte data, word timeMicros)
+{
+  byte tail = _rxRingTail;
+  if ((byte)(tail - _rxRingHead) >= KNXTPUART_RX_RING_SIZE) return false; // ring full
+  _rxRing[tail & (KNXTPUART_RX_RING_SIZE - 1)].data = data;
+  _rxRing[tail & (KNXTPUART_RX_RING_SIZE - 1)].timeMicros = timeMicros;
+  KNXTPUART_RX_RING_BARRIER(); // the data shall be written before being published
+  _rxRingTail = tail + 1;
+  return true;
+}
+
+
+inline byte KnxTpUart::RxRingElementsNb(void) const { return (byte)(_rxRingTail - _rxRingHead); }
+
+
+inline boolean KnxTpUart::PeekRxByte(type_tpuart_rx_byte& rxByte) const
+{
+  byte head = _rxRingHead;
+  if (head == _rxRingTail) return false; // ring empty
+  KNXTPUART_RX_RING_BARRIER(); // the data shall be read after the tail
+  rxByte = _rxRing[head & (KNXTPUART_RX_RING_SIZE - 1)];
+  return true;
+}
+
+
+inline boolean KnxTpUart::PopRxByte(type_tpuart_rx_byte& rxByte)
+{
+  if (!PeekRxByte(rxByte)) return false;
+  KNXTPUART_RX_RING_BARRIER(); // the data shall be read before the slot is released
+  _rxRingHead = _rxRingHead + 1;
+  return true;
+}
 
 
 inline boolean KnxTpUart::IsActive(void) const
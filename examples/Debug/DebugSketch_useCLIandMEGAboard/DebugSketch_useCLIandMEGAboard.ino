@@ -22,12 +22,12 @@ KnxComObject KnxDevice::_comObjectsList[] =
   /* Index 3 */ KnxComObject(G_ADDR(3,0,1), KNX_DPT_9_004 /* 9.004 F16 DPT_Value_Lux */ , COM_OBJ_LOGIC_IN) , // Logical Input Object
 };
 
-const byte KnxDevice::_comObjectsNb = sizeof(_comObjectsList) / sizeof(KnxComObject); // do no change this code
+const type_ComObjectIndex KnxDevice::_comObjectsNb = sizeof(_comObjectsList) / sizeof(KnxComObject); // do no change this code
 
 float luminosity;
 
 // Callback function to handle com objects updates
-void knxEvents(byte index) {
+void knxEvents(type_ComObjectIndex index) {
  if (index==2)
  {
    Knx.read(2,luminosity); Serial.print("lum1="); Serial.println(luminosity);
@@ -18,7 +18,7 @@ KnxComObject KnxDevice::_comObjectsList[] =
   /* Index 1 */ KnxComObject(G_ADDR(0,0,2), KNX_DPT_1_001 /* 1.001 B1 DPT_Switch */ , COM_OBJ_LOGIC_IN_INIT /* Logical Input Object with Init Read */) , 
 };
 
-const byte KnxDevice::_comObjectsNb = sizeof(_comObjectsList) / sizeof(KnxComObject); // do no change this code
+const type_ComObjectIndex KnxDevice::_comObjectsNb = sizeof(_comObjectsList) / sizeof(KnxComObject); // do no change this code
 
 // function and variables to manage push button signal debounce
 static inline word TimeDeltaWord(word now, word before) { return (word)(now - before); }
@@ -28,7 +28,7 @@ word debounceStartTime;
 
 
 // Callback function to handle com objects updates
-void knxEvents(byte index) {}
+void knxEvents(type_ComObjectIndex index) {}
 
 
 void setup(){
@@ -2,6 +2,37 @@
 // Test of the DPT Format <=> C type conversions
 
 #include <KnxDevice.h>
+#include <KnxDPTBulk.h>
+
+// Compare the ConvertFromDptN() results with the ConvertFromDpt() ones (same float bits expected)
+// The DPT values are pseudo random, the 1st chunk starts with the limit values
+// The chunk length is odd so that the end of each array is converted by the scalar path
+#define BULK_CHUNK_NB 29
+boolean CheckBulkConversion(byte dptFormat, byte length)
+{
+  const byte limitValues[4][4] = { {0x00,0x00,0x00,0x00}, {0xFF,0xFF,0xFF,0xFF}, {0x7F,0xFF,0xFF,0xFF}, {0x80,0x00,0x00,0x00} };
+  byte src[BULK_CHUNK_NB * 4];
+  float bulkValues[BULK_CHUNK_NB], value;
+  unsigned long seed = 1;
+
+  for (int chunk = 0; chunk < 64; chunk++)
+  {
+    for (int i = 0; i < BULK_CHUNK_NB * length; i++) { seed = seed * 1103515245UL + 12345; src[i] = (byte)(seed >> 16); }
+    if (chunk == 0) for (int i = 0; i < 4; i++) for (int j = 0; j < length; j++) src[i * length + j] = limitValues[i][j];
+    ConvertFromDptN(src, BULK_CHUNK_NB, bulkValues, dptFormat);
+    for (int i = 0; i < BULK_CHUNK_NB; i++)
+    {
+      ConvertFromDpt(&src[i * length], value, dptFormat);
+      if (memcmp(&value, &bulkValues[i], sizeof(float)))
+      {
+        Serial.print("mismatch for dpt="); for (int j = 0; j < length; j++) { Serial.print(src[i * length + j],HEX); Serial.print(" "); }
+        Serial.print(" scalar=");Serial.print(value); Serial.print(" bulk=");Serial.println(bulkValues[i]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
 void setup()
 {
@@ -27,7 +58,7 @@ void loop()
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueUint);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueUint,HEX);
 
-  Serial.println(F("\n***********DPT U16 => INT (tolerated) ***********"));
+  Serial.println(F("\n***********DPT U16 => INT (saturated to the INT range) ***********"));
   ConvertFromDpt(dptOriginValue,resultValueInt, KNX_DPT_FORMAT_U16);
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueInt);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueInt,HEX);
@@ -37,7 +68,7 @@ void loop()
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueInt);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueInt,HEX);
 
-  Serial.println(F("\n***********DPT V16 => UINT (tolerated) ***********"));
+  Serial.println(F("\n***********DPT V16 => UINT (saturated, negative values give 0) ***********"));
   ConvertFromDpt(dptOriginValue,resultValueUint, KNX_DPT_FORMAT_V16);
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueUint);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueUint,HEX);
@@ -47,7 +78,7 @@ void loop()
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueUlLong);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueUlLong,HEX);
   
-  Serial.println(F("\n***********DPT U32 => LONG (tolerated) ***********"));
+  Serial.println(F("\n***********DPT U32 => LONG (saturated to the LONG range) ***********"));
   ConvertFromDpt(dptOriginValue,resultValueLong, KNX_DPT_FORMAT_U32);
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueLong);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueLong,HEX);
@@ -57,7 +88,7 @@ void loop()
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueLong);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueLong,HEX);
   
-  Serial.println(F("\n***********DPT V32 => ULONG (tolerated) ***********"));
+  Serial.println(F("\n***********DPT V32 => ULONG (saturated, negative values give 0) ***********"));
   ConvertFromDpt(dptOriginValue,resultValueUlLong, KNX_DPT_FORMAT_V32);
   Serial.print("resultValueInt(dec)=");Serial.println(resultValueUlLong);
   Serial.print("resultValueInt(hex)=");Serial.println(resultValueUlLong,HEX);
@@ -225,6 +256,98 @@ void loop()
   for (int i=0; i<2; i++) dptDestValue[i] = 0; // reset dptDestValue
   destValueFloat = 0; // reset destValueFloat
 
+
+  Serial.println(F("\n\n*********************************************************************************************"));
+  Serial.println(F("*********** TEST F16 CONVERSIONS : VALUE x100 => DPT F16 => VALUE x100 (limits and rounding) ***************"));
+  Serial.println(F("*********************************************************************************************"));
+
+  // { value x100, expected DPT F16 value, expected value x100 back }
+  const long f16Tests[][3] = {
+    {         1, 0x0001,         1 }, // min positive value
+    {        -1, 0x87FF,        -1 }, // max negative value
+    {      2047, 0x07FF,      2047 }, // max mantissa, exponent 0
+    {      2048, 0x0C00,      2048 }, // exponent 1
+    {      4093, 0x0FFF,      4094 }, // rounded up (half away from zero), exponent 1
+    {      4095, 0x1400,      4096 }, // rounding overflows the mantissa : exponent 2
+    {     -2048, 0x8000,     -2048 }, // min mantissa, exponent 0
+    {     -2049, 0x8BFF,     -2050 }, // rounded down (half away from zero), exponent 1
+    {     -4096, 0x8800,     -4096 }, // -2048 mantissa with exponent 1 rather than -1024 with exponent 2
+    {     -4097, 0x9400,     -4096 }, // rounded up, exponent 2
+    {  67076096, 0x7FFF,  67076096 }, // max value
+    { -67108864, 0xF800, -67108864 }, // min value
+  };
+  for (byte i = 0; i < sizeof(f16Tests) / sizeof(f16Tests[0]); i++)
+  {
+    ConvertToDptF16(f16Tests[i][0], dptDestValue);
+    ConvertFromDptF16(dptDestValue, destValueLong);
+    Serial.print("originValuex100=");Serial.print(f16Tests[i][0]);
+    Serial.print(" dptDestValue="); for (int j=0; j<2; j++) {   Serial.print(dptDestValue[j],HEX); Serial.print(" "); }
+    Serial.print("destValuex100=");Serial.print(destValueLong);
+    Serial.println( ((dptDestValue[0] == (byte)(f16Tests[i][1] >> 8)) && (dptDestValue[1] == (byte)f16Tests[i][1])
+                     && (destValueLong == f16Tests[i][2])) ? " OK" : " ERROR");
+  }
+  Serial.print("67092480 => DPT F16 (out of range, 255 expected)=");Serial.println(ConvertToDptF16(67092480L, dptDestValue));
+  Serial.print("-67125249 => DPT F16 (out of range, 255 expected)=");Serial.println(ConvertToDptF16(-67125249L, dptDestValue));
+  Serial.print("float NaN => DPT F16 (255 expected)=");Serial.println(ConvertToDpt((float)NAN, dptDestValue, KNX_DPT_FORMAT_F16));
+  Serial.print("double NaN => DPT F16 (255 expected)=");Serial.println(ConvertToDpt((double)NAN, dptDestValue, KNX_DPT_FORMAT_F16));
+  Serial.print("NaN => DPT F16 codec (0 expected)=");Serial.println(KnxDPTCodec<KNX_DPT_FORMAT_F16>::Encode(NAN, dptDestValue));
+
+
+  Serial.println(F("\n\n*********************************************************************************************"));
+  Serial.println(F("*********** TEST F32 CONVERSIONS : float C TYPE => DPT F32 => float C TYPE (byte order, infinities, NaN) ***************"));
+  Serial.println(F("*********************************************************************************************"));
+
+  // the DPT F32 value is sent MSB first (sign and exponent in the 1st byte)
+  const float f32Values[] = { 1.0, -2.5, 123.456, 1.0E-40, INFINITY, -INFINITY };
+  const byte f32ExpectedDpt[][4] = { {0x3F,0x80,0x00,0x00}, {0xC0,0x20,0x00,0x00}, {0x42,0xF6,0xE9,0x79},
+                                     {0x00,0x01,0x16,0xC2}, {0x7F,0x80,0x00,0x00}, {0xFF,0x80,0x00,0x00} };
+  for (byte i = 0; i < sizeof(f32Values) / sizeof(f32Values[0]); i++)
+  {
+    ConvertToDpt(f32Values[i], dptDestValue, KNX_DPT_FORMAT_F32);
+    ConvertFromDpt(dptDestValue, destValueFloat, KNX_DPT_FORMAT_F32);
+    Serial.print("originValueFloat=");Serial.print(f32Values[i]);
+    Serial.print(" dptDestValue="); for (int j=0; j<4; j++) {   Serial.print(dptDestValue[j],HEX); Serial.print(" "); }
+    Serial.print("destValueFloat=");Serial.print(destValueFloat);
+    Serial.println( (!memcmp(dptDestValue, f32ExpectedDpt[i], 4) && !memcmp(&destValueFloat, &f32Values[i], sizeof(float))) ? " OK" : " ERROR");
+  }
+
+  originValueFloat = NAN;
+  ConvertToDpt(originValueFloat, dptDestValue, KNX_DPT_FORMAT_F32);
+  ConvertFromDpt(dptDestValue, destValueFloat, KNX_DPT_FORMAT_F32);
+  Serial.print("originValueFloat=NaN dptDestValue="); for (int j=0; j<4; j++) {   Serial.print(dptDestValue[j],HEX); Serial.print(" "); }
+  Serial.print("destValueFloat=");Serial.print(destValueFloat);
+  // NaN : exponent bits all set, mantissa not null
+  Serial.println( (((dptDestValue[0] & 0x7F) == 0x7F) && (dptDestValue[1] & 0x80) && ((dptDestValue[1] & 0x7F) || dptDestValue[2] || dptDestValue[3])
+                   && (destValueFloat != destValueFloat)) ? " OK" : " ERROR");
+
+
+  Serial.println(F("\n\n*********************************************************************************************"));
+  Serial.println(F("*********** TEST SATURATION : DPT F32 => LONG C TYPE  ***************"));
+  Serial.println(F("*********************************************************************************************"));
+
+  const byte dptF32Big[4] = { 0x71, 0x49, 0xF2, 0xCA }; // 1.0E30
+  const byte dptF32BigNeg[4] = { 0xF1, 0x49, 0xF2, 0xCA }; // -1.0E30
+  const byte dptF32NaN[4] = { 0x7F, 0xC0, 0x00, 0x00 };
+
+  ConvertFromDpt(dptF32Big, destValueLong, KNX_DPT_FORMAT_F32);
+  Serial.print("1.0E30 => destValueLong (LONG max expected)=");Serial.println(destValueLong);
+  ConvertFromDpt(dptF32BigNeg, destValueLong, KNX_DPT_FORMAT_F32);
+  Serial.print("-1.0E30 => destValueLong (LONG min expected)=");Serial.println(destValueLong);
+  ConvertFromDpt(dptF32NaN, destValueLong, KNX_DPT_FORMAT_F32);
+  Serial.print("NaN => destValueLong (0 expected)=");Serial.println(destValueLong);
+
+
+  Serial.println(F("\n\n*********************************************************************************************"));
+  Serial.println(F("*********** TEST BULK CONVERSIONS : ConvertFromDptN() vs ConvertFromDpt()  ***************"));
+  Serial.println(F("*********************************************************************************************"));
+
+  Serial.print("DPT U16 : "); Serial.println(CheckBulkConversion(KNX_DPT_FORMAT_U16, 2) ? "OK" : "ERROR");
+  Serial.print("DPT V16 : "); Serial.println(CheckBulkConversion(KNX_DPT_FORMAT_V16, 2) ? "OK" : "ERROR");
+  Serial.print("DPT F16 : "); Serial.println(CheckBulkConversion(KNX_DPT_FORMAT_F16, 2) ? "OK" : "ERROR");
+  Serial.print("DPT U32 : "); Serial.println(CheckBulkConversion(KNX_DPT_FORMAT_U32, 4) ? "OK" : "ERROR");
+  Serial.print("DPT V32 : "); Serial.println(CheckBulkConversion(KNX_DPT_FORMAT_V32, 4) ? "OK" : "ERROR");
+  Serial.print("DPT F32 : "); Serial.println(CheckBulkConversion(KNX_DPT_FORMAT_F32, 4) ? "OK" : "ERROR");
+
 while(1); // Stop here
 }
 
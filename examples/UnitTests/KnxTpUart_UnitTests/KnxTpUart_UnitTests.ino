@@ -10,7 +10,7 @@
 
 #include <KnxDevice.h>
 // NB 1 : "KNXTPUART_DEBUG_INFO" and "KNXTPUART_DEBUG_ERROR" flags shall be set in order to get KnxTpUart traces
-// NB 2 : IsAddressAssigned() function shall be made public in KnxTpUart class (in KnxTpUart.h file) for Attach_Tests() test
+// NB 2 : FindComObjects() and GetAddrTableComObjectIndex() functions shall be made public in KnxTpUart class (in KnxTpUart.h file) for Attach_Tests() test
 #include <Cli.h> // command line interpreter lib available at https://github.com/franckmarini/Cli
 
 Cli cli = Cli(Serial);
@@ -82,6 +82,7 @@ void Bus_Monitoring(void);      // Test Bus Monitoring mode
 void Normal_Rx(void);           // Test addressed telegrams reception
 void Normal_Rx_ResetEvt(void);  // Test Reset Event reception
 void Normal_Rx_StateEvt(void);  // Test State Event reception
+void Normal_Rx_Busy(void);      // Test BUSY ACK when all the RX slots are pending
 void Normal_Tx_Val0(void);      // Test telegram transmission : Send boolean value 1 to valid address 0x0001 (switch actuator OFF)
 void Normal_Tx_Val1(void);      // Test telegram transmission : Send boolean value 0 to valid address 0x0001 (switch actuator ON)
 void Normal_Tx_NoAck(void);     // Test telegram transmission with NoAck (target address does not exist)
@@ -98,6 +99,7 @@ void setup(){
   cli.RegisterCmd("rx",&Normal_Rx);
   cli.RegisterCmd("rxreset",&Normal_Rx_ResetEvt);
   cli.RegisterCmd("rxstate",&Normal_Rx_StateEvt);
+  cli.RegisterCmd("rxbusy",&Normal_Rx_Busy);
   cli.RegisterCmd("tx0",&Normal_Tx_Val0);  
   cli.RegisterCmd("tx1",&Normal_Tx_Val1);
   cli.RegisterCmd("txnoack",&Normal_Tx_NoAck);
@@ -129,7 +131,7 @@ void Reset_Tests(void)
 
 
 void Attach_Tests()
-// WARNING : IsAddressAssigned() function shall be made public (private by default) for this test
+// WARNING : FindComObjects() and GetAddrTableComObjectIndex() functions shall be made public (private by default) for this test
 {
 byte return_val;
   Serial.println(F("\n########## Attach tests  ##########"));
@@ -162,12 +164,16 @@ byte return_val;
     Serial.print(F("Attach return val = ")); Serial.println(return_val);
     for (byte i=0; i<sizeof(list)/sizeof(KnxComObject); i++)
     {
-      byte index;
-      return_val = tpuart.IsAddressAssigned(list[i].GetAddr(), index);
+      word tableIndex;
+      type_ComObjectIndex nb;
+      return_val = tpuart.FindComObjects(list[i].GetAddr(), tableIndex, nb);
       Serial.print(F("Adress=")); Serial.print(list[i].GetAddr(), HEX);
       if (return_val)
       {
-        Serial.print(F(" => index=")); Serial.println(index);           
+        Serial.print(F(" => index="));
+        for (type_ComObjectIndex rank=0; rank<nb; rank++)
+        { Serial.print(tpuart.GetAddrTableComObjectIndex(tableIndex+rank)); Serial.print(' '); }
+        Serial.println();
       }
       else
       {
@@ -197,12 +203,16 @@ byte return_val;
     Serial.print(F("Attach return val = ")); Serial.println(return_val);
     for (byte i=0; i<sizeof(list)/sizeof(KnxComObject); i++)
     {
-      byte index;
-      return_val = tpuart.IsAddressAssigned(list[i].GetAddr(), index);
+      word tableIndex;
+      type_ComObjectIndex nb;
+      return_val = tpuart.FindComObjects(list[i].GetAddr(), tableIndex, nb);
       Serial.print(F("Adress=")); Serial.print(list[i].GetAddr(), HEX);
       if (return_val)
       {
-        Serial.print(F(" => index=")); Serial.println(index);           
+        Serial.print(F(" => index="));
+        for (type_ComObjectIndex rank=0; rank<nb; rank++)
+        { Serial.print(tpuart.GetAddrTableComObjectIndex(tableIndex+rank)); Serial.print(' '); }
+        Serial.println();
       }
       else
       {
@@ -236,12 +246,16 @@ byte return_val;
     Serial.print(F("Attach return val = ")); Serial.println(return_val);
     for (byte i=0; i<sizeof(list)/sizeof(KnxComObject); i++)
     {
-      byte index;
-      return_val = tpuart.IsAddressAssigned(list[i].GetAddr(), index);
+      word tableIndex;
+      type_ComObjectIndex nb;
+      return_val = tpuart.FindComObjects(list[i].GetAddr(), tableIndex, nb);
       Serial.print(F("Adress=")); Serial.print(list[i].GetAddr(), HEX);
       if (return_val)
       {
-        Serial.print(F(" => index=")); Serial.println(index);           
+        Serial.print(F(" => index="));
+        for (type_ComObjectIndex rank=0; rank<nb; rank++)
+        { Serial.print(tpuart.GetAddrTableComObjectIndex(tableIndex+rank)); Serial.print(' '); }
+        Serial.println();
       }
       else
       {
@@ -275,12 +289,16 @@ byte return_val;
     Serial.print(F("Attach return val = ")); Serial.println(return_val);
     for (byte i=0; i<sizeof(list)/sizeof(KnxComObject); i++)
     {
-      byte index;
-      return_val = tpuart.IsAddressAssigned(list[i].GetAddr(), index);
+      word tableIndex;
+      type_ComObjectIndex nb;
+      return_val = tpuart.FindComObjects(list[i].GetAddr(), tableIndex, nb);
       Serial.print(F("Adress=")); Serial.print(list[i].GetAddr(), HEX);
       if (return_val)
       {
-        Serial.print(F(" => index=")); Serial.println(index);           
+        Serial.print(F(" => index="));
+        for (type_ComObjectIndex rank=0; rank<nb; rank++)
+        { Serial.print(tpuart.GetAddrTableComObjectIndex(tableIndex+rank)); Serial.print(' '); }
+        Serial.println();
       }
       else
       {
@@ -389,7 +407,6 @@ void Normal_Rx(void)
   Serial.println(F("\n########## RX Tests  ##########"));
   Serial.println(F("Press Enter to stop  the test..."));
   KnxTpUart tpuart(Serial1, 0x1234, NORMAL);
-  KnxTelegram &tg = tpuart.GetReceivedTelegram();
   tpuart.SetDebugString(&traces);
   tpuart.Reset();
   tpuart.SetEvtCallback(eventCallback);
@@ -403,11 +420,12 @@ void Normal_Rx(void)
   while(running)
   {
     if(Pulse400us()) tpuart.RXTask();
-    if (newTgEvt)
-    {
-      newTgEvt--;
-      Serial.print("Telegram received, index="); Serial.println(tpuart.GetTargetedComObjectIndex());
-      PrintTelegramInfo(tg);
+    while (tpuart.GetReceivedTelegramsNb())
+    { // the received telegrams stay in the TPUART RX slots till they are released
+      if (newTgEvt) newTgEvt--;
+      Serial.print("Telegram received, index="); Serial.println(tpuart.GetTargetedComObjectIndex(0));
+      PrintTelegramInfo(tpuart.GetReceivedTelegram());
+      tpuart.ReleaseReceivedTelegram();
     }
     if (Serial.available()) running = 0;
   }
@@ -419,7 +437,6 @@ void Normal_Rx_ResetEvt(void)
 {
   Serial.println(F("\n########## Reset Event reception test  ##########"));
   KnxTpUart tpuart(Serial1, 0x1234, NORMAL);
-  KnxTelegram &tg = tpuart.GetReceivedTelegram();
   tpuart.SetDebugString(&traces);
   tpuart.Reset();
   tpuart.SetEvtCallback(eventCallback);
@@ -447,7 +464,6 @@ void Normal_Rx_StateEvt(void)
 {
   Serial.println(F("\n########## State Event reception test  ##########"));  
   KnxTpUart tpuart(Serial1, 0x1234, NORMAL);
-  KnxTelegram &tg = tpuart.GetReceivedTelegram();
   tpuart.SetDebugString(&traces);
   tpuart.Reset();
   tpuart.SetEvtCallback(eventCallback);
@@ -471,6 +487,59 @@ void Normal_Rx_StateEvt(void)
 }
 
 
+// Push a WRITE telegram coming from address 0x1111 as if it was received from the bus, then wait for its End Of Packet
+void PushTelegram(KnxTpUart& tpuart, word targetAddr, byte value)
+{
+  KnxTelegram tg;
+  tg.SetSourceAddress(0x1111);
+  tg.SetTargetAddress(targetAddr);
+  tg.SetCommand(KNX_COMMAND_VALUE_WRITE);
+  tg.SetFirstPayloadByte(value);
+  tg.UpdateChecksum();
+  for (byte i = 0; i < tg.GetTelegramLength(); i++) tpuart.PushRxByte(tg.ReadRawByte(i), (word)micros());
+  delay(3); // EOP detected after 2 ms without byte
+  tpuart.RXTask();
+}
+
+
+void Normal_Rx_Busy(void)
+{
+  Serial.println(F("\n########## RX slots full (BUSY ACK) test  ##########"));
+  KnxTpUart tpuart(Serial1, 0x1234, NORMAL);
+  tpuart.SetDebugString(&traces);
+  tpuart.Reset();
+  tpuart.SetEvtCallback(eventCallback);
+  tpuart.SetAckCallback(ackCallback);
+  tpuart.AttachComObjectsList(objList,sizeof(objList)/sizeof(KnxComObject));
+  tpuart.Init();
+  TracesDisplay();
+  newTgEvt = 0;
+  // KNXTPUART_RX_SLOTS_NB telegrams are received and none of them is released :
+  // the last one is answered with a BUSY ACK (0x13) and does not overwrite any pending telegram
+  Serial.println(F("Receiving telegrams with values 1, 2, 3..."));
+  for (byte value = 1; value <= KNXTPUART_RX_SLOTS_NB; value++) PushTelegram(tpuart, 0x0001, value);
+  TracesDisplay(); // "Rx: no free telegram slot, BUSY sent" expected
+  Serial.print(F("Received telegrams events (")); Serial.print(KNXTPUART_RX_SLOTS_NB - 1); Serial.print(F(" expected)=")); Serial.println(newTgEvt);
+  Serial.print(F("Pending telegrams nb (")); Serial.print(KNXTPUART_RX_SLOTS_NB - 1); Serial.print(F(" expected)=")); Serial.println(tpuart.GetReceivedTelegramsNb());
+  for (byte value = 1; tpuart.GetReceivedTelegramsNb(); value++)
+  {
+    Serial.print(F("Pending telegram value (")); Serial.print(value); Serial.print(F(" expected)="));
+    Serial.println(tpuart.GetReceivedTelegram().GetFirstPayloadByte());
+    tpuart.ReleaseReceivedTelegram();
+  }
+  // the sender repeats the telegram answered BUSY, it is now received
+  PushTelegram(tpuart, 0x0001, KNXTPUART_RX_SLOTS_NB);
+  TracesDisplay();
+  Serial.print(F("Repeated telegram value (")); Serial.print(KNXTPUART_RX_SLOTS_NB); Serial.print(F(" expected)="));
+  if (tpuart.GetReceivedTelegramsNb())
+  {
+    Serial.println(tpuart.GetReceivedTelegram().GetFirstPayloadByte());
+    tpuart.ReleaseReceivedTelegram();
+  }
+  else Serial.println(F("none"));
+}
+
+
 void Normal_Tx_Val1(void)
 {
   Serial.println(F("\n########## Telegram Transmission Test (value 1)  ##########"));  
@@ -670,6 +739,7 @@ void All_Tests(void)
   Normal_Rx(); TracesDisplay();
   Normal_Rx_ResetEvt(); TracesDisplay();
   Normal_Rx_StateEvt(); TracesDisplay();
+  Normal_Rx_Busy(); TracesDisplay();
   Normal_Tx_Val0(); TracesDisplay();
   Normal_Tx_Val1(); TracesDisplay();
   Normal_Tx_NoAck(); TracesDisplay();
@@ -3,13 +3,18 @@
 
 Cli cli = Cli(Serial);
 
-RingBuffer<long, 8> buffer; // Ring buffer containing up to 8 long values
+ActionRingBuffer<long, 8> buffer; // Ring buffer containing up to 8 long values
+ActionScheduler<long, 8, 2> scheduler; // Scheduler with a normal priority queue of 8 long values, urgent queues of 2 values
 long counter = 1;
 
 void Add(void);
 void Pop(void);
 void Info(void);
 void Scenario(void);
+void ReplaceScenario(void);
+void OverflowScenario(void);
+void SchedulerScenario(void);
+void StarvationScenario(void);
 
 
 void setup() {
@@ -17,6 +22,10 @@ void setup() {
   cli.RegisterCmd("p",&Pop);
   cli.RegisterCmd("i",&Info);
   cli.RegisterCmd("s",&Scenario);
+  cli.RegisterCmd("r",&ReplaceScenario);
+  cli.RegisterCmd("o",&OverflowScenario);
+  cli.RegisterCmd("u",&SchedulerScenario);
+  cli.RegisterCmd("b",&StarvationScenario);
   Serial.begin(115200);
 }
 
@@ -74,3 +83,120 @@ void Scenario(void) {
 }
 
 
+// Replace() predicate : both values have the same tens digit
+boolean IsSameTens(const long& value1, const long& value2) { return ((value1 / 10) == (value2 / 10)); }
+
+
+void Replace(long value) {
+  if (buffer.Replace(value, &IsSameTens)) { Serial.print(F("Value ")); Serial.print(value,DEC); Serial.println(F(" replaced in place")); }
+  else { Serial.print(F("Value ")); Serial.print(value,DEC); Serial.println(F(" not replaced (no matching value), nothing appended")); }
+}
+
+
+void ReplaceScenario(void) {
+  long popVal;
+  while (buffer.Pop(popVal)); // buffer emptied
+  buffer.Append(11); buffer.Append(21); buffer.Append(31); // values 11, 21, 31
+  Replace(25); // value 21 replaced by 25
+  Replace(27); // value 25 replaced by 27
+  Replace(45); // no value replaced
+  Info(); // show 3 elements, 2 replaced
+  for( int i=1; i<=3; i++) Pop(); // Pop values 11, 27, 31 (the replaced value kept its position)
+  Pop(); // tell buffer is empty
+}
+
+
+// Overflow policies callbacks
+void Dropped(const long& value) { Serial.print(F("Value ")); Serial.print(value,DEC); Serial.println(F(" dropped")); }
+
+boolean WaitPopping(void) { // the consumer makes some progress
+  Serial.print(F("Waiting for free space : ")); Pop(); return true;
+}
+
+boolean WaitStuck(void) { // the consumer makes no progress
+  delay(10); return true;
+}
+
+boolean WaitImpossible(void) { return false; }
+
+
+void TryAdd(boolean blockAllowed) {
+  if (buffer.Append(counter, blockAllowed)) { Serial.print(F("Value ")); Serial.print(counter,DEC); Serial.println(F(" appended")); }
+  else { Serial.print(F("Value ")); Serial.print(counter,DEC); Serial.println(F(" rejected")); }
+  counter++;
+}
+
+
+void Fill(void) {
+  long popVal;
+  while (buffer.Pop(popVal)); // buffer emptied
+  Serial.println("counter value reset"); counter = 1;
+  for( int i=1; i<=8; i++) Add(); // Append 8 elements (value 1 to 8)
+}
+
+
+void OverflowScenario(void) {
+  Serial.println(F("*** DROP_OLDEST policy ***"));
+  buffer.SetOverflowPolicy(ACTIONRINGBUFFER_DROP_OLDEST, &Dropped, NULL, 0);
+  Fill();
+  TryAdd(true); // value 1 dropped, value 9 appended
+  Pop(); // value 2 popped
+
+  Serial.println(F("*** REJECT_NEWEST policy ***"));
+  buffer.SetOverflowPolicy(ACTIONRINGBUFFER_REJECT_NEWEST, NULL, NULL, 0);
+  Fill();
+  TryAdd(true); // value 9 rejected
+  Pop(); // value 1 popped
+
+  Serial.println(F("*** BLOCK policy ***"));
+  buffer.SetOverflowPolicy(ACTIONRINGBUFFER_BLOCK, NULL, &WaitPopping, 100);
+  Fill();
+  TryAdd(true); // value 1 popped while waiting, value 9 appended
+  TryAdd(false); // blocking not allowed : value 10 rejected without waiting
+  buffer.SetOverflowPolicy(ACTIONRINGBUFFER_BLOCK, NULL, &WaitStuck, 100);
+  TryAdd(true); // no space freed : value 11 rejected after 100 ms
+  buffer.SetOverflowPolicy(ACTIONRINGBUFFER_BLOCK, NULL, &WaitImpossible, 100);
+  TryAdd(true); // waiting not possible : value 12 rejected
+  Pop(); // value 2 popped
+  Info(); // tell 4 rejected elements, 3 blocked appends and 2 block timeouts (scenario run first)
+
+  buffer.SetOverflowPolicy(ACTIONRINGBUFFER_DROP_OLDEST, NULL, NULL, 0); // default policy
+}
+
+
+void SchedulerScenario(void) {
+  long popVal;
+  scheduler.Append(1, KNX_PRIORITY_NORMAL_VALUE);
+  scheduler.Append(2, KNX_PRIORITY_NORMAL_VALUE);
+  scheduler.Append(101, KNX_PRIORITY_HIGH_VALUE);
+  scheduler.Append(201, KNX_PRIORITY_ALARM_VALUE);
+  scheduler.Append(301, KNX_PRIORITY_SYSTEM_VALUE);
+  scheduler.Append(3, KNX_PRIORITY_NORMAL_VALUE);
+  Serial.println(F("Values 1, 2 (normal prio), 101 (high prio), 201 (alarm prio), 301 (system prio), 3 (normal prio) appended"));
+  // Pop values 301, 201, 101 (urgent ones first, by priority), then 1, 2, 3 (normal ones in order)
+  while (scheduler.Pop(popVal)) { Serial.print(F("Popped value ")); Serial.println(popVal,DEC); }
+  Serial.println(F("Scheduler empty"));
+}
+
+
+void StarvationScenario(void) {
+  long popVal;
+  byte bypassNb = 0;
+  scheduler.Append(1, KNX_PRIORITY_NORMAL_VALUE);
+  Serial.println(F("Value 1 (normal prio) appended, then one high prio value appended before each pop"));
+  // The high prio stream never empties, value 1 is popped once the normal queue has been bypassed
+  // ACTIONSCHEDULER_MAX_BYPASS_NB times
+  for (long value = 101; value < 101 + 2 * ACTIONSCHEDULER_MAX_BYPASS_NB; value++)
+  {
+    scheduler.Append(value, KNX_PRIORITY_HIGH_VALUE);
+    scheduler.Pop(popVal);
+    Serial.print(F("Popped value ")); Serial.println(popVal,DEC);
+    if (popVal == 1) break;
+    bypassNb++;
+  }
+  Serial.print(F("Value 1 popped after ")); Serial.print(bypassNb,DEC); Serial.print(F(" bypasses ("));
+  Serial.print(ACTIONSCHEDULER_MAX_BYPASS_NB,DEC); Serial.print(F(" expected)"));
+  Serial.println(((popVal == 1) && (bypassNb == ACTIONSCHEDULER_MAX_BYPASS_NB)) ? F(" OK") : F(" ERROR"));
+  while (scheduler.Pop(popVal)) { Serial.print(F("Popped value ")); Serial.println(popVal,DEC); }
+  Serial.println(F("Scheduler empty"));
+}